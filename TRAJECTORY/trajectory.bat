@@ -62,4 +62,61 @@ set DATAUNIT=0
 rem zeitliche Winddatenaufloesung (0: max. 24h)
 set RES=3
 
+rem Auftragsdatei fuer Batchbetrieb (leer: aus)
+set JOBS=
+
+rem Anzahl der Threads (0: Prozessoranzahl)
+set THREADS=1
+
+rem Abstandswichtung (0: Bogen, 1: Sehne, 2: Bogen als Polynom)
+set WEIGHTMODE=0
+
+rem gepacktes Winddatenarchiv (leer: METEO lesen)
+set ARCHIVE=
+
+rem METEO in dieses Archiv packen (leer: aus)
+set PACK=
+
+rem Tage im Speicher (0: alle vorab einlesen)
+set WINDOW=0
+
+rem naechsten Tag vorausladen (nur mit WINDOW oder SERIES)
+set PREFETCH=1
+
+rem Parameterstudie, z.B. SPEED=1.5,2 ROT=0,10 (leer: aus)
+set SWEEP=
+
+rem Gitterweite der Gitter-Windfelder in Grad (0.0: aus)
+set GRID=0.0
+
+rem Verzeichnis der Gitter-Windfelder (leer: nur im Speicher)
+set GRIDCACHE=
+
+rem Windgitterdatei (leer: Stationsmeldungen)
+set WINDGRID=
+
+rem Anzahl naechster Stationen (0: alle im Radius MAXR)
+set KNEAREST=0
+
+rem Obergrenze des Abstands bei KNEAREST in km (0: keine)
+set KMAXR=0
+
+rem Interpolation in Delaunay-Dreiecken (0: aus, 1: an)
+set DELAUNAY=0
+
+rem Integrationsverfahren (0: Euler, 1: Heun, 2: Runge-Kutta 4)
+set INTEGRATOR=0
+
+rem Fehlertoleranz je Schritt in km (0.0: feste Schritte IPERH)
+set TOL=0.0
+
+rem Integration im Raum der Einheitsvektoren (0: aus, 1: an)
+set VECTOR=0
+
+rem Trajektorien je Gruppe im Gleichschritt (0: aus)
+set LOCKSTEP=0
+
+rem Zeitreihe: Endzeit und Schrittweite in h, z.B. 2007 12 31 21 3 (leer: aus)
+set SERIES=
+
 trajectory.exe
\ No newline at end of file
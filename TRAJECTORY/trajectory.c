@@ -70,6 +70,306 @@
  *                   HH:   Stunde
  * ausgegeben.
  *
+ * *******************
+ * *ABSTANDSWICHTUNG*
+ * *******************
+ * Die Winddaten der Stationen im Berechnungsgebiet werden mit 1 / r^2 
+ * gewichtet. Der Abstand r kann auf drei Arten bestimmt werden 
+ * (Parameter WEIGHTMODE), c = cos(theta) ist dabei das Skalarprodukt der 
+ * Ortsvektoren von Berechnungspunkt und Station, theta ihr Winkelabstand:
+ *
+ *  0: Bogenlaenge        r^2 = acos(c)^2 = theta^2
+ *     (urspruengliches Verfahren, eine acos-Berechnung pro Station)
+ *
+ *  1: Sehnenlaenge       r^2 = 2 - 2c = theta^2 (1 - theta^2/12 + ...)
+ *     Die Sehne ist kuerzer als der Bogen. Die relative Abweichung der 
+ *     Gewichte von Verfahren 0 betraegt hoechstens theta^2/12, fuer 
+ *     MAXR = 200 km also 8e-5 (MAXR = 1000 km: 2e-3). Da sich die 
+ *     Abweichung bei der Normierung der Gewichte weitgehend aufhebt, 
+ *     ist der Einfluss auf den Windvektor noch deutlich geringer.
+ *
+ *  2: Bogenlaenge als Polynom der Sehnenlaenge (t = 2 - 2c)
+ *                        r^2 = t + t^2/12 + t^3/90 + t^4/560
+ *     Abgebrochene Reihe von (2 asin(sqrt(t)/2))^2 = theta^2. Der relative
+ *     Fehler gegenueber Verfahren 0 ist kleiner als t^4/3150, fuer 
+ *     MAXR <= 2000 km also kleiner als 3e-8 (MAXR = 200 km: 3e-16) und 
+ *     damit in der Groessenordnung der Rundungsfehler von acos().
+ *
+ * Die Verfahren 1 und 2 kommen ohne transzendente Funktionen aus und werden
+ * im IDW-Kern vollstaendig vektorisiert berechnet.
+ *
+ * ***************
+ * *BATCHBETRIEB*
+ * ***************
+ * Ist der Parameter JOBS gesetzt, werden in einem Programmlauf alle in der
+ * angegebenen Auftragsdatei aufgefuehrten Trajektorien berechnet. Jede Zeile
+ * der Auftragsdatei beschreibt eine Trajektorie:
+ *  LO LA YYYY MM DD HH TRACE
+ *  13.4167 52.5167 2007 01 01 12 -96
+ * Leerzeilen und mit '#' beginnende Zeilen werden ignoriert. Die Stations-
+ * liste und alle von den Auftraegen benoetigten Tagesdatensaetze werden nur
+ * einmal eingelesen und von allen Trajektorien gemeinsam (nur lesend)
+ * genutzt. Die uebrigen Parameter gelten fuer alle Auftraege, die Werte von
+ * LO, LA, YYYY, MM, DD, HH und TRACE werden ignoriert.
+ *
+ * Mit dem Parameter THREADS koennen die Auftraege auf mehrere Threads 
+ * verteilt werden (0: Anzahl der Prozessoren). Jeder Thread bearbeitet 
+ * zunaechst einen zusammenhaengenden Block von Auftraegen; ist sein Block 
+ * abgearbeitet, uebernimmt er noch nicht begonnene Auftraege vom Ende der 
+ * Bloecke anderer Threads (work stealing). Da jede Trajektorie unabhaengig
+ * von allen anderen berechnet wird, sind die Ergebnisse unabhaengig von der
+ * Anzahl der Threads. An den Namen jeder Ausgabedatei wird die Start-
+ * position angehaengt (z.B. B20070101_12_LO13.416700_LA52.516700.trj).
+ * Auftraege, die dieselbe Ausgabedatei erzeugen wuerden, werden vor der 
+ * Berechnung mit einer Fehlermeldung abgewiesen.
+ * Auch das Einlesen der Tagesdatensaetze vor der Berechnung wird auf 
+ * THREADS Threads verteilt: Jeder Thread liest ganze Tage in eigene Puffer,
+ * die anschliessend in zeitlicher Reihenfolge (ohne Kopie) in die Zeitfolge
+ * uebernommen werden. Jede Tagesdatei darf dazu nur Datenbloecke ihres 
+ * eigenen Tages enthalten.
+ * (Threads werden nur unterstuetzt, wenn mit USE_PTHREAD uebersetzt wurde.)
+ *
+ * ***************************
+ * *GEPACKTES WINDDATENARCHIV*
+ * ***************************
+ * Ist der Parameter PACK gesetzt, werden keine Trajektorien berechnet, 
+ * sondern alle Tagesdatensaetze im Verzeichnis METEO eingelesen und in die
+ * angegebene Archivdatei geschrieben. Das Archiv enthaelt die der 
+ * Stationsliste zugeordneten, unkorrigierten Windmeldungen (Richtung und
+ * Geschwindigkeit) jeder Stunde (als Liste der Stationen mit Daten) sowie
+ * einen Stundenindex. Wird das Archiv beim Trajektorienlauf ueber den 
+ * Parameter ARCHIVE angegeben, werden die Winddaten ohne Textverarbeitung 
+ * und ohne Kopie direkt im (mit USE_MMAP nur lesend eingeblendeten) Archiv
+ * verwendet. Die Stationsliste muss dabei mit der beim Packen ueberein-
+ * stimmen, SPEED, ROT und DATAUNIT koennen frei gewaehlt werden. Das 
+ * Archiv ist nur auf Systemen mit gleicher Byte-Reihenfolge und gleichen
+ * Datentypgroessen lesbar.
+ *  PACK=meteo.pak ./trajectory
+ *  ARCHIVE=meteo.pak ./trajectory
+ *
+ * **********************
+ * *TAGEWEISES NACHLADEN*
+ * **********************
+ * Standardmaessig werden alle von den Auftraegen benoetigten Tagesdaten-
+ * saetze vor der Berechnung eingelesen. Ist der Parameter WINDOW gesetzt,
+ * wird ein Tagesdatensatz erst eingelesen, wenn eine Trajektorie ihn 
+ * erreicht. Jede Trajektorie haelt nur die Tage ihrer beiden aktuellen 
+ * Daten-Windfelder und gibt Tage, die sie hinter sich gelassen hat, wieder
+ * frei. Freigegebene Tage bleiben eingelesen, bis WINDOW Tage im Speicher 
+ * sind, und werden dann (der am laengsten unbenutzte zuerst) verworfen; 
+ * Tage, die kein noch nicht erledigter Auftrag mehr benoetigt, werden 
+ * sofort verworfen. 
+ * Der Speicherbedarf haengt damit nicht mehr von TRACE, sondern nur von 
+ * WINDOW und der Anzahl der Threads ab; bricht eine Trajektorie vorzeitig
+ * ab, werden die uebrigen Tage gar nicht erst eingelesen. Die Ergebnisse 
+ * sind dieselben wie beim vollstaendigen Einlesen. Im Batchbetrieb mit 
+ * zeitlich weit verstreuten Auftraegen kann ein Tag mehrfach eingelesen 
+ * werden; dort lohnt ein groesseres WINDOW oder ein Winddatenarchiv.
+ *  WINDOW=4 TRACE=-720 ./trajectory
+ *
+ * Mit PREFETCH=1 (und USE_PTHREAD) liest ein eigener Thread den in 
+ * Berechnungsrichtung folgenden Tag ein, waehrend die Trajektorien noch 
+ * rechnen. Er legt ihn in einem von zwei Puffern ab, aus dem er beim 
+ * Erreichen des Tages nur noch uebernommen wird; der andere Puffer nimmt
+ * derweil schon den naechsten Tag auf. Die Anzahl der Faelle, in denen 
+ * eine Trajektorie dennoch auf Winddaten warten musste (Tag noch nicht 
+ * fertig oder nicht vorausgeladen), wird am Programmende ausgegeben.
+ *
+ * ***************************
+ * *KOMPRIMIERTE TAGESDATEIEN*
+ * ***************************
+ * Fehlt eine Tagesdatei bYYMMDD.new in METEO, wird stattdessen 
+ * bYYMMDD.new.gz (mit USE_ZLIB uebersetzt, -lz) bzw. bYYMMDD.new.zst (mit
+ * USE_ZSTD uebersetzt, -lzstd) gelesen. Die Datei wird beim Einlesen 
+ * schrittweise im Speicher entpackt; ein Entpacken in ein Zwischen-
+ * verzeichnis ist nicht noetig. Auch PACK nimmt komprimierte Tagesdateien
+ * auf.
+ *  (cd meteo && gzip *.new)
+ *  ./trajectory
+ *
+ * *****************
+ * *PARAMETERSTUDIE*
+ * *****************
+ * Die Winddaten werden unkorrigiert gespeichert; SPEED, ROT und DATAUNIT
+ * werden erst bei der Berechnung jeder Trajektorie angewendet. Ist der 
+ * Parameter SWEEP gesetzt, wird deshalb jede Trajektorie (bzw. jeder
+ * Auftrag im Batchbetrieb) in einem Programmlauf fuer alle Kombinationen
+ * der angegebenen Werte von SPEED, ROT, MAXR und MINR berechnet, ohne die
+ * Winddaten mehrfach einzulesen. SWEEP enthaelt durch Leerzeichen 
+ * getrennte Wertelisten, nicht aufgefuehrte Parameter behalten ihren Wert.
+ * An den Namen jeder Ausgabedatei werden die Werte der Kombination 
+ * angehaengt (z.B. B20070101_12_SPEED1.5_ROT10_MAXR200_MINR2.trj). Der 
+ * raeumliche Stationsindex wird fuer MAXR aufgebaut.
+ *  SWEEP="SPEED=1.5,2,2.5 ROT=0,10 MAXR=150,200" ./trajectory
+ *
+ * *******************
+ * *GITTER-WINDFELDER*
+ * *******************
+ * Ist GRID gesetzt, wird jedes Stunden-Windfeld einmal mit dem IDW-Kern
+ * auf ein Laengen-/Breitengitter der Weite GRID Grad interpoliert, das
+ * alle Stationen mit einem Rand von MAXR ueberdeckt. Die Trajektorien 
+ * interpolieren den Wind dann nur noch bilinear aus den Gittern; alle
+ * Trajektorien mit gleichen Winddaten und Parametern nutzen dieselben 
+ * Gitter. Eine Abdeckungsmaske markiert die Gitterpunkte mit Stationen 
+ * in Reichweite, die Trajektorie endet, wenn nicht alle vier umgebenden 
+ * Gitterpunkte abgedeckt sind. Die Gitter werden bei der ersten Benutzung 
+ * berechnet; ist GRIDCACHE angegeben, werden sie dort gespeichert und 
+ * von spaeteren Programmlaeufen eingeblendet. Der Dateiname ist ein
+ * Hashwert ueber Winddaten, Gitter und Interpolationsparameter, so dass 
+ * geaenderte Daten oder Parameter nie ein veraltetes Gitter treffen. Da 
+ * IDW um die Stationen Spitzen bildet, sollte GRID deutlich kleiner als
+ * der Stationsabstand sein (z.B. 0.02 Grad). Lohnend ist das Gitter fuer
+ * grosse Ensembles und wiederholte Laeufe ueber denselben Zeitraum.
+ *  mkdir grid
+ *  GRID=0.02 GRIDCACHE=grid/ JOBS=ensemble.txt THREADS=0 ./trajectory
+ *
+ * ********************
+ * *NAECHSTE STATIONEN*
+ * ********************
+ * Ist KNEAREST gesetzt, werden statt aller Stationen im Radius MAXR die
+ * KNEAREST naechsten Stationen mit Daten jedes Stunden-Windfelds fuer
+ * die Interpolation verwendet. In dichten Netzen bleibt so der Aufwand
+ * je Zeitschritt begrenzt, in duennen Netzen endet die Trajektorie nicht
+ * mehr, weil keine Station innerhalb von MAXR liegt. Die Suche erweitert
+ * den Radius um die Position ringweise ueber den Stationsindex, bis je
+ * Stunden-Windfeld KNEAREST Stationen gefunden sind; die Auswahl wird
+ * erst neu bestimmt, wenn sich die Position um den Rand verschoben hat
+ * oder ein neues Stunden-Windfeld beginnt. KMAXR begrenzt den Abstand 
+ * der Stationen (0: unbegrenzt), MAXR wird nur als Rand der Gitter-
+ * Windfelder (GRID, ohne KMAXR) verwendet; MINR und STDDEVIATION wirken
+ * wie bei der Auswahl nach Radius.
+ *  KNEAREST=8 KMAXR=500 ./trajectory
+ *
+ * ******************
+ * *DELAUNAY-DREIECKE*
+ * ******************
+ * Ist DELAUNAY gesetzt, wird der Wind statt mit IDW baryzentrisch im 
+ * Dreieck der Delaunay-Triangulation (auf der Kugel) interpoliert, das 
+ * die Position enthaelt. Die Triangulation wird einmal je Stunden-
+ * Windfeld aus den Stationen mit Daten berechnet und von allen 
+ * Trajektorien und Stunden mit denselben Stationen gemeinsam genutzt. 
+ * Jeder Schritt sucht sein Dreieck ab dem Dreieck des letzten Schritts,
+ * der Aufwand je Schritt ist daher unabhaengig von der Stationsdichte. 
+ * An den Stationen gibt die Interpolation genau deren Meldungen wieder.
+ * Ausserhalb des Stationsnetzes (Dreiecke am Rand mit sehr grossem 
+ * Umkreis eingeschlossen) endet die Trajektorie. MAXR, MINR, 
+ * STDDEVIATION, WEIGHTMODE, KNEAREST und GRID werden nicht verwendet.
+ *  DELAUNAY=1 JOBS=ensemble.txt ./trajectory
+ *
+ * ***********************
+ * *INTEGRATIONSVERFAHREN*
+ * ***********************
+ * Standardmaessig wird die Position mit IPERH Euler-Schritten je Stunde 
+ * fortgeschrieben. Mit INTEGRATOR 1 (Heun) bzw. 2 (klassisches Runge-
+ * Kutta-Verfahren) wird der Wind je Schritt zwei- bzw. viermal an 
+ * Zwischenpositionen und -zeiten ausgewertet; der Fehler faellt dann 
+ * quadratisch bzw. mit der vierten Potenz der Schrittweite. Bei einem 
+ * glatten Windfeld (z.B. WINDGRID) ist RK4 mit IPERH=2 genauer als Euler 
+ * mit IPERH=20; bei Stationsdaten begrenzen die Spruenge des IDW-Felds 
+ * am Rand von MAXR die Ordnung, Heun mit IPERH=4 erreicht dort etwa die 
+ * Genauigkeit von Euler mit IPERH=20. IPERPOINT ist dann entsprechend 
+ * anzupassen (z.B. IPERH=4 IPERPOINT=4 fuer stuendliche Aufpunkte).
+ *  INTEGRATOR=2 IPERH=4 IPERPOINT=4 ./trajectory
+ *
+ * Mit TOL > 0 wird die Schrittweite statt fest ueber IPERH gesteuert 
+ * (eingebettetes Bogacki-Shampine-Verfahren 3(2), INTEGRATOR wird nicht 
+ * verwendet): Jeder Schritt schaetzt seinen Fehler und wird wiederholt,
+ * wenn dieser TOL (km) uebersteigt. In ruhiger, glatter Stroemung sind 
+ * die Schritte bis zu eine Stunde lang, an Fronten und Datenluecken 
+ * werden sie kurz. Die Aufpunkte entstehen weiter im Takt IPERPOINT / 
+ * IPERH Stunden, die Ausgabedateien bleiben also gleich aufgebaut. Bei 
+ * Stationsdaten ist TOL=0.1 genauer als Euler mit IPERH=20 und braucht 
+ * weniger als die Haelfte der Windauswertungen.
+ *  TOL=0.1 ./trajectory
+ *
+ * Mit VECTOR=1 wird statt (lo, la) der Ortsvektor auf der Einheitskugel
+ * integriert (mit allen Verfahren und mit TOL): Der Wind wird in der 
+ * Tangentialebene nach Osten und Norden zerlegt und nach jedem Schritt 
+ * auf die Kugel zurueckprojiziert. Die Schritte brauchen so ausser einer
+ * Wurzel keine Winkelfunktionen mehr und die Division durch cos la 
+ * entfaellt, Trajektorien ueber oder nahe den Polen bleiben stabil. lo
+ * und la werden nur fuer die Aufpunkte berechnet.
+ *  VECTOR=1 INTEGRATOR=2 IPERH=4 IPERPOINT=4 ./trajectory
+ *
+ * *****************
+ * *WINDGITTERDATEI*
+ * *****************
+ * Statt der Stationsmeldungen kann eine Windgitterdatei mit u und v auf 
+ * einem regelmaessigen Laengen-/Breitengitter (z.B. Bodenwind einer 
+ * Reanalyse) verwendet werden (WINDGRID). Die Datei wird eingeblendet; 
+ * der Wind wird raeumlich bilinear und zwischen den Feldern der Datei
+ * zeitlich linear interpoliert, eine Stationssuche entfaellt. STATION, 
+ * METEO, ARCHIVE, MAXR, MINR, STDDEVIATION, DATAUNIT, RES und GRID werden
+ * nicht verwendet, SPEED und ROT wie bei den Stationsmeldungen angewendet
+ * (fuer unkorrigierte Gitterwinde SPEED=1 ROT=0). Ausserhalb des Gitters,
+ * an Fehlwerten und ausserhalb des Zeitraums der Datei endet die 
+ * Trajektorie. Ueberdeckt das Gitter alle Laengengrade, wird ueber den 
+ * Rand hinweg interpoliert.
+ * Aufbau der Datei (Bytereihenfolge des Rechners, ohne Fuellbytes):
+ *  char[8]   "TRJWIND"
+ *  int       Formatversion 1
+ *  int       0x01020304
+ *  int       lo_max, la_max   Anzahl der Gitterpunkte (Laenge, Breite)
+ *  int       hour_max         Anzahl der Felder
+ *  int       first            Zeit des ersten Felds (Stunden seit dem
+ *                             01.01.1970 00 Uhr GMT)
+ *  int       step             Abstand der Felder (h)
+ *  int       0
+ *  double    lo_first, la_first, lo_step, la_step (Grad)
+ *  je Feld   float u[la_max][lo_max], float v[la_max][lo_max]
+ *            (m/s, Windrichtung wohin, Zeilen von Sueden nach Norden, 
+ *            Fehlwerte NaN)
+ *  WINDGRID=era5_2007.bin SPEED=1 ROT=0 JOBS=jobs.txt ./trajectory
+ *
+ * ***************
+ * *GLEICHSCHRITT*
+ * ***************
+ * Im Batchbetrieb erzeugt jede Trajektorie ihre Stunden-Windfelder 
+ * selbst, auch wenn sich die Berechnungszeitraeume vieler Trajektorien 
+ * ueberschneiden. Ist LOCKSTEP gesetzt, werden bis zu LOCKSTEP Auftraege 
+ * mit gleicher Richtung, SPEED und ROT und sich ueberschneidenden 
+ * Berechnungszeitraeumen zu einer Gruppe zusammengefasst, die Stunde fuer
+ * Stunde gemeinsam fortgeschrieben wird: Die Stunden-Windfelder werden je 
+ * Stunde nur einmal erzeugt, jede Trajektorie steigt zu ihrer Startzeit 
+ * ein. Die gepackten Stationsdaten aller Trajektorien der Gruppe liegen 
+ * verschraenkt hintereinander, der IDW-Kern berechnet mit AVX2 vier 
+ * Trajektorien gleichzeitig. Mit THREADS werden die Gruppen auf die 
+ * Threads verteilt. Die Ergebnisse sind bitgleich zur Einzelberechnung; 
+ * nur der letzte Schritt einer mangels Winddaten abgebrochenen 
+ * Trajektorie verwendet den zuletzt berechneten Windvektor der 
+ * Trajektorie. LOCKSTEP wird nur mit Stationsmeldungen, IDW ohne 
+ * STDDEVIATION, KNEAREST, GRID und DELAUNAY sowie festen Euler-Schritten 
+ * (INTEGRATOR=0, TOL=0.0, VECTOR=0) verwendet.
+ *  LOCKSTEP=8 JOBS=ensemble.txt THREADS=0 ./trajectory
+ *
+ * ***********
+ * *ZEITREIHE*
+ * ***********
+ * Ist SERIES gesetzt ("YYYY MM DD HH STEP"), wird die Trajektorie (bzw. 
+ * jeder Auftrag im Batchbetrieb) ab ihrer Startzeit alle STEP Stunden 
+ * bis einschliesslich zur angegebenen Endzeit (Zeitzone der Startzeit)
+ * erneut gestartet, z.B. eine 96-h-Rueckwaertstrajektorie alle drei 
+ * Stunden eines ganzen Jahres am selben Empfaengerort. Die Tagesdaten-
+ * saetze werden dabei tageweise nachgeladen (auch mit WINDOW=0, dann 
+ * ohne Obergrenze): Fuer jeden Tag wird gezaehlt, wie viele Auftraege 
+ * ihn benoetigen. Ein Tag wird eingelesen, wenn die erste Trajektorie 
+ * ihn erreicht, und verworfen, sobald der letzte Auftrag, der ihn 
+ * benoetigt, erledigt ist. Mit WINDOW=0 wird so jeder Tag nur einmal 
+ * eingelesen; im Speicher liegen alle Tage, die schon erreicht wurden 
+ * und von einem noch nicht erledigten Auftrag benoetigt werden. Mit 
+ * THREADS sind das bis zu den Tagen der Abschnitte aller Threads. Mit 
+ * WINDOW > 0 werden zusaetzlich die am laengsten unbenutzten Tage 
+ * verworfen und bei Bedarf erneut eingelesen; WINDOW muss dann je 
+ * Thread mindestens die Tage einer Trajektorie plus zwei fassen 
+ * (ceil(|TRACE| / 24) + 2), kleinere Werte werden abgewiesen. Mit 
+ * PREFETCH wird der Starttag des jeweils naechsten Auftrags vorausgeladen.
+ * Die Auftraege einer Zeitreihe haben verschiedene Startzeiten und 
+ * damit verschiedene Ausgabedateien; mit THREADS bearbeitet jeder Thread
+ * einen zusammenhaengenden Abschnitt der Zeitreihe, mit LOCKSTEP teilen 
+ * sich benachbarte Auftraege die Stunden-Windfelder.
+ *  YYYY=2007 MM=01 DD=01 HH=00 TRACE=-96 SERIES="2007 12 31 21 3" 
+ *  ./trajectory
+ *
  * *******
  * *START*
  * *******
@@ -104,6 +404,36 @@
  * Windgeschwindigkeitseinheit
  * (0:kn, 1:m/s, 2:aus Stationsliste)           DATAUNIT          0
  * zeitliche Aufloesung der Winddatensaetze (h) RES               3
+ * Auftragsdatei (Batchbetrieb, leer: aus)      JOBS
+ * Abstandswichtung (0: Bogen, 1: Sehne,
+ * 2: Bogen als Polynom)                        WEIGHTMODE        0
+ * Anzahl der Threads (0: Prozessoranzahl)      THREADS           1
+ * gepacktes Winddatenarchiv (leer: METEO)      ARCHIVE
+ * METEO in Archiv packen und beenden           PACK
+ * Tage im Speicher (0: alle vorab einlesen)    WINDOW            0
+ * naechsten Tag vorausladen (0: aus, 1: an)    PREFETCH          1
+ * Parameterstudie (leer: aus)                  SWEEP
+ * Gitterweite der Gitter-Windfelder
+ * (Grad, 0: aus)                               GRID              0.0
+ * Verzeichnis der Gitter-Windfelder
+ * (leer: aus)                                  GRIDCACHE
+ * Windgitterdatei (leer: Stationsmeldungen)    WINDGRID
+ * Anzahl der naechsten Stationen
+ * (0: alle im Radius MAXR)                     KNEAREST          0
+ * Obergrenze des Abstands bei KNEAREST
+ * (km, 0: keine)                               KMAXR             0
+ * Interpolation in Delaunay-Dreiecken
+ * (0: aus, 1: an)                              DELAUNAY          0
+ * Integrationsverfahren
+ * (0: Euler, 1: Heun, 2: Runge-Kutta 4)        INTEGRATOR        0
+ * Fehlertoleranz je Schritt bei Schrittweiten-
+ * steuerung (km, 0.0: feste Schritte IPERH)    TOL               0.0
+ * Integration im Raum der Einheitsvektoren
+ * (0: aus, 1: an)                              VECTOR            0
+ * Trajektorien je Gruppe im Gleichschritt
+ * (0: aus)                                     LOCKSTEP          0
+ * Zeitreihe: Endzeit und Schrittweite (h)
+ * ("YYYY MM DD HH STEP", leer: aus)            SERIES
  */
 
 /*
@@ -111,51 +441,248 @@
  *
  * main()
  * .      read_env()
+ * .      pack_archive()
+ * .      .      read_station_list()
+ * .      .      .      init_station_catalog()
+ * .      .      .      init_station_index()
+ * .      .      date_to_hours()
+ * .      .      read_day()
+ * .      .      .      generate_input_filename()
+ * .      .      .      read_file()
+ * .      .      .      .      read_compressed()
+ * .      .      .      .      scan_int()
+ * .      .      .      .      find_station()
+ * .      .      .      .      store_field()
+ * .      .      reset_archive()
+ * .      read_jobs()
+ * .      series_jobs()
+ * .      .      date_to_hours()
+ * .      .      hours_to_date()
+ * .      sweep_jobs()
+ * .      select_idw_kernel()
+ * .      init_archive()
+ * .      .      open_stations() | open_windgrid()
+ * .      check_lockstep()
+ * .      group_jobs()
+ * .      .      compare_jobs()
+ * .      .      .      date_to_hours()
+ * .      .      date_to_hours()
+ * .      run_jobs()
+ * .      .      take_job()
+ * .      .      prefetch_job()
+ * .      .      .      convert_timezone()
+ * .      .      .      prefetch_day()
+ * .      .      run_lockstep()
+ * .      .      .      init_lockstep()
+ * .      .      .      .      init_values()
+ * .      .      .      calculate_lockstep()
+ * .      .      .      .      begin_stations()
+ * .      .      .      .      advance_stations()
+ * .      .      .      .      convert_geo_to_cartesian()
+ * .      .      .      .      update_candidates()
+ * .      .      .      .      pack_lane()
+ * .      .      .      .      .      pack_candidates()
+ * .      .      .      .      idw_kernel_lanes_avx2() | 
+ * .      .      .      .      idw_kernel_lanes_scalar()
+ * .      .      .      .      blend_wind_vector()
+ * .      .      .      .      normalize_coords()
+ * .      .      .      print_output_file()
+ * .      .      .      reset_lockstep()
+ * .      .      .      .      reset_state()
+ * .      .      .      retire_days()
+ * .      run_job()
  * .      init_values()
- * .      .      get_amount_of_stations()
+ * .      .      convert_timezone()
+ * .      .      .      date_to_hours()
  * .      .      normalize_coords()
  * .      calculate()
  * .      .      prepare_calculate()
- * .      .      .      convert_timezone()
- * .      .      .      read_station_list()
- * .      .      .      new_winddata()
- * .      .      .      read_wind_data()
- * .      .      .      .      time_step_forward()
- * .      .      .      .      time_step_backward()
- * .      .      .      .      read_file()
- * .      .      .      init_wind_data()
- * .      .      .      .      get_next_element()
- * .      .      .      .      get_prev_element()
- * .      .      .      check_resolution()
- * .      .      .      wind_of_next_hour()
+ * .      .      .      begin_stations() | begin_windgrid()
  * .      .      iterate()
- * .      .      .      copy_wind_current()
- * .      .      .      get_next_wind_data()
- * .      .      .      .      get_next_element()
- * .      .      .      .      get_prev_element()
- * .      .      .      check_resolution()
- * .      .      .      wind_of_next_hour()
+ * .      .      .      load_position()
+ * .      .      .      .      convert_geo_to_cartesian()
+ * .      .      .      advance_stations() | advance_windgrid()
  * .      .      .      convert_geo_to_cartesian()
  * .      .      .      calculate_wind_vector()
- * .      .      .      .      check_station_weight()
- * .      .      .      .      .      distance_to_station_in_cos()
- * .      .      .      .      average_sum()
- * .      .      .      .      deviation_sum()
- * .      .      .      .      std_deviation()
- * .      .      .      .      z_transformation()
- * .      .      .      .      end_sum()
+ * .      .      .      .      lookup_stations() | lookup_windgrid()
+ * .      .      .      .      blend_wind_vector()
+ * .      .      .      integrate_step()
+ * .      .      .      .      calculate_step()
+ * .      .      .      .      .      convert_geo_to_cartesian() | 
+ * .      .      .      .      .      normalize_vector()
+ * .      .      .      .      .      calculate_wind_vector()
+ * .      .      .      .      normalize_vector()
+ * .      .      .      integrate_adaptive()
+ * .      .      .      .      advance_stations() | advance_windgrid()
+ * .      .      .      .      calculate_step()
+ * .      .      .      .      normalize_vector()
+ * .      .      .      store_position()
+ * .      .      .      .      normalize_vector()
  * .      .      normalize_coords()
  * .      print_output_file()
  * .      .      generate_output_filename()
  * .      reset_state()
+ * .      .      end_stations()
+ * .      retire_days()
+ * .      .      collect_days()
+ * .      .      free_day()
+ * .      reset_archive()
+ * .      .      close_stations() | close_windgrid()
+ *
+ * Windquelle Stationsmeldungen (station_source):
+ *
+ * open_stations()
+ * .      read_station_list()
+ * .      .      init_station_catalog()
+ * .      .      init_station_index()
+ * .      map_archive()
+ * .      read_wind_data()
+ * .      .      collect_days()
+ * .      .      .      convert_timezone()
+ * .      .      .      .      date_to_hours()
+ * .      .      init_timeline()
+ * .      .      drop_prefetch()
+ * .      .      prefetch_main() (Thread)
+ * .      .      .      drop_prefetch()
+ * .      .      .      decode_day()
+ * .      .      ingest_days()
+ * .      .      .      ingest_main() (Threads)
+ * .      .      .      .      decode_day()
+ * .      .      .      .      .      read_day()
+ * .      .      .      .      .      .      read_packed_day()
+ * .      .      .      .      .      .      generate_input_filename()
+ * .      .      .      .      .      .      .      hours_to_date()
+ * .      .      .      .      .      .      read_file()
+ * .      .      .      .      .      .      .      read_compressed()
+ * .      .      .      .      .      .      .      scan_int()
+ * .      .      .      .      .      .      .      date_to_hours()
+ * .      .      .      .      .      .      .      find_station()
+ * .      .      .      .      .      .      .      store_field()
+ * .      .      .      splice_day()
+ * begin_stations()
+ * .      init_grid_shape()
+ * .      init_wind_data()
+ * .      .      find_field()
+ * .      .      .      hold_days()
+ * .      .      .      .      acquire_day()
+ * .      .      .      .      .      load_day()
+ * .      .      .      .      .      .      decode_day()
+ * .      .      .      .      .      .      free_day()
+ * .      .      .      .      .      .      splice_day()
+ * .      .      .      .      .      .      drop_prefetch()
+ * .      .      .      .      .      .      init_timeline()
+ * .      .      .      .      release_day()
+ * .      .      .      .      prefetch_day()
+ * .      .      hold_days()
+ * .      check_resolution()
+ * .      wind_of_next_hour()
+ * .      .      correct_wind()
+ * .      .      release_grid()
+ * .      .      .      free_grid()
+ * .      .      acquire_grid()
+ * .      .      .      grid_key()
+ * .      .      .      .      hash_bytes()
+ * .      .      .      read_grid()
+ * .      .      .      .      generate_grid_filename()
+ * .      .      .      .      free_grid()
+ * .      .      .      build_grid()
+ * .      .      .      .      convert_geo_to_cartesian()
+ * .      .      .      .      find_stations()
+ * .      .      .      .      pack_candidates()
+ * .      .      .      .      update_nearest()
+ * .      .      .      .      pack_nearest()
+ * .      .      .      .      idw_kernel_avx2() | ...
+ * .      .      .      .      idw_kernel_filtered()
+ * .      .      .      .      generate_grid_filename()
+ * .      .      .      free_grid()
+ * .      .      release_mesh()
+ * .      .      .      free_mesh()
+ * .      .      acquire_mesh()
+ * .      .      .      hash_bytes()
+ * .      .      .      build_mesh()
+ * .      .      .      .      triple_product()
+ * .      .      .      .      append_triangle()
+ * .      .      .      .      walk_mesh()
+ * .      .      .      .      .      triple_product()
+ * .      .      .      .      inside_circle()
+ * .      .      .      .      .      triple_product()
+ * .      .      .      free_mesh()
+ * advance_stations()
+ * .      copy_wind_current()
+ * .      get_next_wind_data()
+ * .      .      find_field()
+ * .      .      hold_days()
+ * .      check_resolution()
+ * .      wind_of_next_hour()
+ * .      .      correct_wind()
+ * .      .      release_grid()
+ * .      .      acquire_grid()
+ * .      .      release_mesh()
+ * .      .      acquire_mesh()
+ * lookup_stations()
+ * .      lookup_mesh()
+ * .      .      walk_mesh()
+ * .      .      triple_product()
+ * .      lookup_grid()
+ * .      update_candidates()
+ * .      .      find_stations()
+ * .      pack_candidates()
+ * .      update_nearest()
+ * .      .      find_stations()
+ * .      .      select_nearest()
+ * .      pack_nearest()
+ * .      .      select_nearest()
+ * .      idw_kernel_avx2() | idw_kernel_sse2() | 
+ * .      idw_kernel_scalar()
+ * .      idw_kernel_filtered()
+ * .      .      average_sum()
+ * .      .      std_deviation()
+ * end_stations()
+ * .      hold_days()
+ * .      release_grid()
+ * .      release_mesh()
+ * close_stations()
+ * .      drop_prefetch()
+ * .      free_grid()
+ * .      free_mesh()
+ *
+ * Windquelle Windgitterdatei (windgrid_source):
+ *
+ * open_windgrid()
+ * .      hours_to_date()
+ * begin_windgrid()
+ * advance_windgrid()
+ * lookup_windgrid()
+ * .      sample_windgrid()
+ * close_windgrid()
  */   
 
 #include <assert.h>
 #include <ctype.h>
+#include <dirent.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#ifdef USE_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+/* SIMD-Varianten des IDW-Kerns nur fuer x86-64 mit GCC-kompatiblem Compiler */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define USE_SIMD
+#include <immintrin.h>
+#endif
 
 /***********
  * DEFINES *
@@ -164,6 +691,25 @@
 #define RE        6370.0 /* Erdradius in km */
 #define MAXLINE   256    /* maximale Zeichenanzahl pro Zeichenkette */
 #define RESMAX    24     /* maximaler Zeitabstand der Winddaten in h */
+#define CELLMIN   0.25   /* minimale Zellgroesse des Stationsindex in Grad */
+#define MARGIN    20.0   /* Sicherheitsabstand der Kandidatenliste in km */
+#define LANES     4      /* Anzahl paralleler Summen im IDW-Kern */
+#define PACKMAGIC "TRJPACK" /* Kennung des gepackten Winddatenarchivs */
+#define PACKVER   3      /* Formatversion des gepackten Winddatenarchivs */
+#define GRIDMAGIC "TRJGRID" /* Kennung eines Gitter-Windfelds */
+#define GRIDVER   1      /* Formatversion der Gitter-Windfelder */
+#define GRIDKEEP  48     /* unbenutzt im Speicher gehaltene Gitter-Windfelder */
+#define GRIDBLOCK 8      /* Gitterpunkte je Blockseite in build_grid() */
+#define MESHGHOST 4      /* Hilfspunkte der Delaunay-Triangulationen */
+#define MESHKEEP  48     /* unbenutzt im Speicher gehaltene Triangulationen */
+#define STEPMIN   1e-4   /* kleinste Schrittweite bei TOL > 0 in h */
+#define WINDGRIDMAGIC "TRJWIND" /* Kennung einer Windgitterdatei */
+#define WINDGRIDVER 1    /* Formatversion der Windgitterdateien */
+
+/* Koeffizienten der Reihe theta^2(t) fuer WEIGHTMODE 2 */
+#define C12       (1.0 / 12)
+#define C90       (1.0 / 90)
+#define C560      (1.0 / 560)
 
 /****************
  * DECLARATIONS *
@@ -247,6 +793,63 @@ struct param {
 	{"RES",          TYP_INT,    { "3" }, 
 	 "resolution of wind data (0:off)"},
 
+	{"JOBS",         TYP_STRING, { "" }, 
+	 "file of trajectory jobs (batch mode)"},
+
+	{"THREADS",      TYP_INT,    { "1" }, 
+	 "number of threads (0: number of processors)"},
+
+	{"WEIGHTMODE",   TYP_INT,    { "0" }, 
+	 "distance weighting (0:arc, 1:chord, 2:arc polynomial)"},
+
+	{"ARCHIVE",      TYP_STRING, { "" }, 
+	 "packed wind data archive (empty: read METEO)"},
+
+	{"PACK",         TYP_STRING, { "" }, 
+	 "pack METEO into this archive and exit"},
+
+	{"WINDOW",       TYP_INT,    { "0" }, 
+	 "days of wind data kept in memory (0: all)"},
+
+	{"PREFETCH",     TYP_INT,    { "1" }, 
+	 "prefetch next day in background (WINDOW > 0 or SERIES)"},
+
+	{"SWEEP",        TYP_STRING, { "" }, 
+	 "parameter sweep, e.g. \"SPEED=1.5,2 ROT=0,10\" (empty: off)"},
+
+	{"GRID",         TYP_FLOAT,  { "0.0" }, 
+	 "resolution of gridded wind fields [degree] (0.0: off)"},
+
+	{"GRIDCACHE",    TYP_STRING, { "" }, 
+	 "directory of cached gridded wind fields (empty: off)"},
+
+	{"WINDGRID",     TYP_STRING, { "" }, 
+	 "gridded wind file (empty: station reports)"},
+
+	{"KNEAREST",     TYP_INT,    { "0" }, 
+	 "number of nearest stations (0: all within MAXR)"},
+
+	{"KMAXR",        TYP_INT,    { "0" }, 
+	 "distance cap of KNEAREST [km] (0: none)"},
+
+	{"DELAUNAY",     TYP_INT,    { "0" }, 
+	 "barycentric interpolation in Delaunay triangles (0: off, 1: on)"},
+
+	{"INTEGRATOR",   TYP_INT,    { "0" }, 
+	 "integration scheme (0: Euler, 1: Heun, 2: RK4)"},
+
+	{"TOL",          TYP_FLOAT,  { "0.0" }, 
+	 "error tolerance of adaptive steps [km] (0.0: fixed IPERH)"},
+
+	{"VECTOR",       TYP_INT,    { "0" }, 
+	 "integration in unit vector space (0: off, 1: on)"},
+
+	{"LOCKSTEP",     TYP_INT,    { "0" }, 
+	 "trajectories advanced together per wind hour (0: off)"},
+
+	{"SERIES",       TYP_STRING, { "" }, 
+	 "time series: end \"YYYY MM DD HH\" and step [h] (empty: off)"},
+
 	{NULL,           0,          { NULL }, NULL }
 };
 
@@ -271,7 +874,26 @@ enum {
 	OUTPUT       = 17,
 	STDDEVIATION = 18,
 	DATAUNIT     = 19,
-	RES          = 20
+	RES          = 20,
+	JOBS         = 21,
+	THREADS      = 22,
+	WEIGHTMODE   = 23,
+	ARCHIVE      = 24,
+	PACK         = 25,
+	WINDOW       = 26,
+	PREFETCH     = 27,
+	SWEEP        = 28,
+	GRID         = 29,
+	GRIDCACHE    = 30,
+	WINDGRID     = 31,
+	KNEAREST     = 32,
+	KMAXR        = 33,
+	DELAUNAY     = 34,
+	INTEGRATOR   = 35,
+	TOL          = 36,
+	VECTOR       = 37,
+	LOCKSTEP     = 38,
+	SERIES       = 39
 };
 
 /* Datenelement fuer eine Station (Stationsliste) */
@@ -280,9 +902,12 @@ struct station {
         /* Stationsnummer */
 	int nr; 
 	
-        /* Messeinheit in der die Station Windgeschwindigkeiten misst */
+        /* Messeinheit laut Stationsinformationsdatei (1: m/s, 2: kn) */
 	int unit;   
 
+	/* 1, wenn die Station (nach DATAUNIT) in Knoten misst */
+	int knots;
+
         /* Stationsposition in kartesischen Koordinaten */
 	double X[3]; 
 };
@@ -295,16 +920,443 @@ struct date {
 	int hour;
 };
 
-/* Windvektor einer Station */
+/* 
+ * Unkorrigierte Windmeldung einer Station, wie sie in der Tagesdatei steht
+ * (Element eines Daten-Windfelds)
+ */
+struct report {
+	int s;         /* Stationsindex (station_list) */
+	int direction; /* Windrichtung (Grad) */
+	int speed;     /* Windgeschwindigkeit (Messeinheit der Station) */
+};
+
+/* 
+ * Daten-Windfeld einer Stunde: Liste der Stationen mit Daten, aufsteigend
+ * nach Stationsindex geordnet
+ */
+struct field {
+	int            n;      /* Anzahl der Stationen mit Daten */
+	struct report* report; /* Windmeldungen (NULL: kein Windfeld) */
+};
+
+/* 
+ * Korrigierter Windvektor einer Station mit Daten (Element eines 
+ * Stunden-Windfelds)
+ */
 struct wind {
+	int    s; /* Stationsindex (station_list) */
 	double u; /* 1ste Dimension des Windvektors */
 	double v; /* 2te Dimension des Windvektors */
-	int    p; /* Present-Flag (0: present, 1: empty) */
+};
+
+/* 
+ * Stunden-Windfeld einer Trajektorie: mit SPEED, ROT und DATAUNIT des
+ * Auftrags korrigierte Windvektoren der Stationen mit Daten, aufsteigend
+ * nach Stationsindex geordnet
+ */
+struct wind_field {
+	int          n;    /* Anzahl der Stationen mit Daten */
+	struct wind* wind; /* Windvektoren */
+};
+
+/*
+ * Raeumlicher Index ueber die Stationsliste. Die Erdoberflaeche ist in 
+ * gleich grosse Laengen-/Breitengradzellen eingeteilt, zu jeder Zelle sind
+ * die darin liegenden Stationen (aufsteigend nach Stationsindex) 
+ * gespeichert.
+ */
+struct station_index {
+	int     lo_max;  /* Anzahl der Zellen in Laengenrichtung */
+	int     la_max;  /* Anzahl der Zellen in Breitenrichtung */
+	double  lo_cell; /* Zellbreite in Laengenrichtung (Rad) */
+	double  la_cell; /* Zellbreite in Breitenrichtung (Rad) */
+
+	/* 
+	 * Index des ersten Eintrags jeder Zelle in station 
+	 * (la_max * lo_max + 1 Elemente)
+	 */
+	int*    first;
+
+	/* nach Zellen geordnete Stationsindizes */
+	int*    station;
+};
+
+/*
+ * Stationskatalog: Hashtabelle (offene Adressierung, lineares Sondieren) 
+ * von der Stationsnummer auf den Index in der Stationsliste
+ */
+struct station_catalog {
+	int  size; /* Anzahl der Tabellenplaetze (Zweierpotenz) */
+	int* slot; /* erster Stationsindex je Platz (-1: leer) */
+
+	/* 
+	 * Index der naechsten Station mit gleicher Stationsnummer (-1: keine),
+	 * mehrfach aufgefuehrte Stationen erhalten alle dieselben Winddaten
+	 */
+	int* same;
+};
+
+/*
+ * Fuer den IDW-Kern gepackte Daten der Kandidatenstationen (structure of 
+ * arrays). Die Felder sind mit leeren Stationen (Maske 0) auf ein 
+ * Vielfaches von LANES aufgefuellt.
+ */
+struct kernel {
+	int     mode;     /* Abstandswichtung (WEIGHTMODE) */
+	int     n;        /* Anzahl der gepackten Stationen (inkl. Fuellung) */
+	int     rebuild;  /* Stand der Kandidatenliste beim Packen */
+	int     hour;     /* Stand von wind_current beim Packen */
+
+	/* Stationspositionen in kartesischen Koordinaten */
+	double* x;
+	double* y;
+	double* z;
+
+	/* 
+	 * Windvektoren und Present-Masken (1.0: present, 0.0: empty) von 
+	 * wind_current[0] (u1, v1, m1) und wind_current[1] (u2, v2, m2)
+	 */
+	double* u1;
+	double* v1;
+	double* m1;
+	double* u2;
+	double* v2;
+	double* m2;
+
+	/* Arbeitsfelder fuer idw_kernel_filtered() */
+	double* w;
+	int*    p1;
+	int*    p2;
+};
+
+/* Gewichtete Summen der beiden Stunden-Windfelder in wind_current */
+struct idw_sum {
+	double u[2];
+	double v[2];
+	double weight[2];
+};
+
+/*
+ * Kopf einer Windgitterdatei (WINDGRID). Auf den Kopf folgen hour_max 
+ * Felder im Abstand von step Stunden mit jeweils u und v (je lo_max * 
+ * la_max float in m/s, zeilenweise von Sueden nach Norden und von Westen 
+ * nach Osten). Fehlwerte sind NaN.
+ */
+struct windgrid_header {
+	char   magic[8];   /* WINDGRIDMAGIC */
+	int    version;    /* WINDGRIDVER */
+	int    byte_order; /* 0x01020304 in der Bytereihenfolge der Datei */
+	int    lo_max;     /* Anzahl der Gitterpunkte in Laengenrichtung */
+	int    la_max;     /* Anzahl der Gitterpunkte in Breitenrichtung */
+	int    hour_max;   /* Anzahl der Felder */
+	int    first;      /* Zeit des ersten Felds (Stunden seit 1970, GMT) */
+	int    step;       /* Abstand der Felder (h) */
+	int    reserved;   /* 0 */
+	double lo_first;   /* Laengengrad des ersten Gitterpunkts (Grad) */
+	double la_first;   /* Breitengrad des ersten Gitterpunkts (Grad) */
+	double lo_step;    /* Gitterweite in Laengenrichtung (Grad) */
+	double la_step;    /* Gitterweite in Breitenrichtung (Grad) */
+};
+
+/* Startparameter einer einzelnen Trajektorienberechnung (Auftrag) */
+struct job {
+	double      lo;    /* Startposition Laengengrad (Grad) */
+	double      la;    /* Startposition Breitengrad (Grad) */
+	struct date time;  /* Startzeit (Zeitzone der Startzeit) */
+	int         trace; /* Verfolgungszeit (h) */
+	double      speed; /* Geschwindigkeitskorrektur (SPEED) */
+	double      rot;   /* Richtungskorrektur (ROT, Grad) */
+	int         maxr;  /* Berechnungsgebietsradius (MAXR, km) */
+	int         minr;  /* Mindestwichtungsdistanz (MINR, km) */
+};
+
+/*
+ * Zeitlich lueckenlose Folge der eingelesenen Stunden-Windfelder. Das 
+ * Windfeld der Stunde t (Stunden seit dem 01.01.1970 00 Uhr GMT) steht in
+ * field[t - first]. Stunden ohne Daten (und nicht eingelesene Tage zwischen
+ * den eingelesenen Tagen) haben kein Windfeld (field[i].wind == NULL).
+ */
+struct timeline {
+	int           first;    /* erste Stunde (Stunden seit 1970) */
+	int           hour_max; /* Anzahl der Stunden */
+	struct field* field;    /* Stunden-Windfelder */
+
+	/* 
+	 * Index des letzten Windfelds mit Daten bis einschliesslich Stunde i
+	 * (prev[i]) bzw. des ersten Windfelds mit Daten ab einschliesslich
+	 * Stunde i (next[i]), -1 wenn kein solches Windfeld existiert
+	 */
+	int*          prev;
+	int*          next;
+
+	/* 
+	 * 1, wenn field[i] direkt in das eingeblendete Winddatenarchiv zeigt
+	 * (und nicht freigegeben werden darf)
+	 */
+	char*         mapped;
+};
+
+/* 
+ * Puffer fuer einen ausserhalb der Zeitfolge eingelesenen Tag (Vorauslade-
+ * Thread, paralleles Einlesen)
+ */
+struct prefetch {
+	int          day;                /* Tagesindex (-1: leer) */
+	int          seq;                /* Reihenfolge der Fertigstellung */
+	int          unknown_count;      /* unbekannte Stationen des Tages */
+	struct field field[24];          /* Stunden-Windfelder des Tages */
+	char         mapped[24];         /* siehe struct timeline */
+	enum {
+		PREFETCH_EMPTY,
+		PREFETCH_LOADING,
+		PREFETCH_READY
+	} state;
+};
+
+/*
+ * Verwaltung der tageweise nachgeladenen Winddaten (WINDOW > 0 oder 
+ * SERIES). Fuer jeden Tag der Zeitfolge (Tagesindex d, Stunden 24 d bis 
+ * 24 d + 23) wird gezaehlt, wie viele Trajektorien ihn gerade halten und
+ * wie viele noch nicht erledigte Auftraege ihn benoetigen.
+ */
+struct day_cache {
+#ifdef USE_PTHREAD
+	pthread_mutex_t lock;
+	pthread_cond_t  wake;   /* neue Vorausladeanforderung oder Ende */
+	pthread_cond_t  done;   /* Vorausladen eines Tages beendet */
+	pthread_t       thread; /* Vorauslade-Thread */
+#endif
+	int   day_max;     /* Anzahl der Tage der Zeitfolge */
+	int*  ref;         /* Anzahl der Trajektorien, die den Tag halten */
+	int*  used;        /* Stand von clock bei der letzten Freigabe */
+	int*  needed;      /* Anzahl der unerledigten Auftraege mit dem Tag */
+	char* loaded;      /* 1, wenn der Tag eingelesen ist */
+	char* counted;     /* 1, wenn der Tag schon einmal eingelesen wurde */
+	char* loading;     /* 1, waehrend eine Trajektorie den Tag einliest */
+	int   clock;       /* Anzahl der bisherigen Freigaben */
+	int   loaded_max;  /* Anzahl der eingelesenen Tage */
+	int   loaded_peak; /* Hoechstzahl gleichzeitig eingelesener Tage */
+	int   load_count;  /* Anzahl der Einlesevorgaenge */
+
+	/* Vorausladen des in Berechnungsrichtung naechsten Tages */
+	int   prefetch;       /* 1, wenn der Vorauslade-Thread laeuft */
+	int   stop;           /* 1: Vorauslade-Thread beenden */
+	int   request;        /* vorauszuladender Tag (-1: keiner) */
+	int   seq;            /* Anzahl der fertig vorausgeladenen Tage */
+	int   prefetch_count; /* Anzahl der uebernommenen Tage */
+	int   stall_count;    /* Anzahl der Wartefaelle */
+	struct prefetch slot[2];
+};
+
+/*
+ * Kopf des gepackten Winddatenarchivs (siehe pack_archive()). Auf den Kopf
+ * folgen die Stationstabelle (station_max * struct pack_station), der
+ * Stundenindex (hour_max * struct pack_hour) und die Windfelder 
+ * (jeweils count * struct report).
+ */
+struct pack_header {
+	char   magic[8];       /* PACKMAGIC */
+	int    version;        /* PACKVER */
+	int    byte_order;     /* 0x01020304 in Byte-Reihenfolge des Packers */
+
+	/* Groessen der Datenstrukturen (muessen beim Lesen gleich sein) */
+	int    size_header;
+	int    size_hour;
+	int    size_report;
+
+	int    station_max;    /* Anzahl der Stationen */
+	int    first;          /* erste Stunde (Stunden seit 1970) */
+	int    hour_max;       /* Anzahl der Stunden */
+
+	long   station_offset; /* Dateiposition der Stationstabelle */
+	long   hour_offset;    /* Dateiposition des Stundenindex */
+};
+
+/* Eintrag der Stationstabelle des Winddatenarchivs */
+struct pack_station {
+	int nr;   /* Stationsnummer */
+	int unit; /* Messeinheit laut Stationsinformationsdatei */
+};
+
+/* Eintrag des Stundenindex des Winddatenarchivs */
+struct pack_hour {
+	long offset; /* Dateiposition des Windfelds */
+	int  count;  /* Anzahl der Stationen mit Daten */
+
+	/* 
+	 * Art des Eintrags:
+	 * PACK_MISSING: Tagesdatei war beim Packen nicht vorhanden
+	 * PACK_NONE:    keine Daten zu dieser Stunde
+	 * PACK_FIELD:   Windfeld mit count Stationen
+	 */
+	enum {
+		PACK_MISSING = -1,
+		PACK_NONE    = 0,
+		PACK_FIELD   = 1
+	} kind;
+};
+
+/*
+ * Kopf und Geometrie eines Gitter-Windfelds (siehe build_grid()). Auf den
+ * Kopf folgen u und v (jeweils lo_max * la_max float, zeilenweise von 
+ * Sueden nach Norden und von Westen nach Osten) und die Abdeckungsmaske
+ * (lo_max * la_max Byte, 0: keine Station in Reichweite).
+ */
+struct grid_header {
+	char   magic[8];  /* GRIDMAGIC */
+	int    version;   /* GRIDVER */
+	int    lo_max;    /* Anzahl der Gitterpunkte in Laengenrichtung */
+	int    la_max;    /* Anzahl der Gitterpunkte in Breitenrichtung */
+	double lo_first;  /* Laengengrad des ersten Gitterpunkts (Rad) */
+	double la_first;  /* Breitengrad des ersten Gitterpunkts (Rad) */
+	double step;      /* Gitterweite (Rad) */
+	unsigned long long key; /* Schluessel (siehe grid_key()) */
+};
+
+/* Gitter-Windfeld im Speicher */
+struct grid {
+	unsigned long long  key;   /* Schluessel (siehe grid_key()) */
+	int                 ref;   /* Anzahl der haltenden Trajektorien */
+	int                 mapped; /* 1, wenn data eingeblendet ist */
+	char*               data;  /* Kopf und Felder wie in der Datei */
+	long                size;  /* Groesse von data */
+	const struct grid_header* header;
+	const float*         u;
+	const float*         v;
+	const unsigned char* mask;
+	struct grid*        next;  /* naechstes Gitter (zuletzt benutzte zuerst) */
+};
+
+/*
+ * Von allen Trajektorien gemeinsam genutzte Gitter-Windfelder (GRID > 0). 
+ * Unbenutzte Gitter bleiben bis zu GRIDKEEP Stueck im Speicher.
+ */
+struct grid_cache {
+#ifdef USE_PTHREAD
+	pthread_mutex_t lock;
+#endif
+	struct grid* list;        /* Gitter im Speicher */
+	int          idle_count;  /* Anzahl der unbenutzten Gitter in list */
+	int          build_count; /* Anzahl der berechneten Gitter */
+	int          read_count;  /* Anzahl der aus GRIDCACHE gelesenen Gitter */
+	long         search_count; /* Stationssuchen in build_grid() */
+};
+
+/*
+ * Dreieck einer Delaunay-Triangulation (siehe build_mesh()): Ecken v 
+ * (Eckenindizes, von aussen gesehen gegen den Uhrzeigersinn) und 
+ * Nachbardreiecke n (n[i] liegt gegenueber der Ecke v[i])
+ */
+struct triangle {
+	int v[3];
+	int n[3];
+};
+
+/*
+ * Delaunay-Triangulation der Stationen mit Daten eines Stunden-Windfelds
+ * im Speicher. Die ersten MESHGHOST Ecken sind Hilfspunkte, die das 
+ * Stationsnetz zu einer Triangulation der ganzen Kugel ergaenzen.
+ */
+struct mesh {
+	unsigned long long key;     /* Hashwert ueber station */
+	int              ref;       /* Anzahl der haltenden Trajektorien */
+	int              station_max; /* Anzahl der Stationen mit Daten */
+	int*             station;   /* Stationsindizes (aufsteigend) */
+	int              vertex_max; /* Anzahl der Ecken */
+	int*             vertex;    /* Stationsindex je Ecke (-1: Hilfspunkt) */
+	double*          X;         /* kartesische Koordinaten je Ecke */
+	int              triangle_max; /* Anzahl der Dreiecke */
+	struct triangle* triangle;
+	struct mesh*     next;      /* naechste Triangulation (zuletzt 
+	                               benutzte zuerst) */
+};
+
+/*
+ * Von allen Trajektorien gemeinsam genutzte Delaunay-Triangulationen
+ * (DELAUNAY = 1). Unbenutzte Triangulationen bleiben bis zu MESHKEEP 
+ * Stueck im Speicher.
+ */
+struct mesh_cache {
+#ifdef USE_PTHREAD
+	pthread_mutex_t lock;
+#endif
+	struct mesh* list;        /* Triangulationen im Speicher */
+	int          idle_count;  /* Anzahl der unbenutzten in list */
+	int          build_count; /* Anzahl der berechneten */
+};
+
+/*
+ * Eingabedaten, die von allen Trajektorienberechnungen gemeinsam genutzt
+ * werden. Nach dem Einlesen werden die Daten nur noch gelesen; bei 
+ * tageweisem Nachladen werden nur die Tage der Zeitfolge (unter 
+ * cache.lock) eingelesen und verworfen.
+ */
+struct archive {
+
+        /* Anzahl der in der Stationsliste enthaltenen Stationen */
+	int station_max; 
+
+        /* Struktur zum Speichern der Stationsinformationen */
+	struct station* station_list; 
+
+	/* Raeumlicher Index ueber station_list */
+	struct station_index index;
+
+	/* Zuordnung der Stationsnummern zu station_list */
+	struct station_catalog catalog;
+
+	/* 
+	 * Anzahl der eingelesenen Winddatenzeilen von Stationen, die nicht in
+	 * der Stationsliste enthalten sind
+	 */
+	int unknown_count;
+
+	/* Nach Stunden indizierte eingelesene Stunden-Windfelder */
+	struct timeline timeline;
+
+	/* Tageweises Nachladen (cache.ref == NULL: alle Tage eingelesen) */
+	struct day_cache cache;
+
+	/* Gitter-Windfelder (GRID > 0) */
+	struct grid_cache grids;
+
+	/* Delaunay-Triangulationen (DELAUNAY = 1) */
+	struct mesh_cache meshes;
+
+	/* 
+	 * Eingeblendetes gepacktes Winddatenarchiv (ARCHIVE) und seine 
+	 * Groesse (NULL: Winddaten werden aus METEO gelesen)
+	 */
+	char* pack;
+	long  pack_size;
+
+	/* 
+	 * Eingeblendete Windgitterdatei (WINDGRID) und ihre Groesse (NULL: 
+	 * Stationsmeldungen)
+	 */
+	char* windgrid;
+	long  windgrid_size;
 };
 
 /* Struktur zur Speicherung des momentanen Programmstatus */
 struct state {
 
+	/* Startparameter der Trajektorie */
+	struct job job;
+
+	/* 
+	 * gemeinsam genutzte Eingabedaten (nur lesend, bis auf das 
+	 * tageweise Nachladen)
+	 */
+	struct archive* archive;
+
+	/* 
+	 * Von der Trajektorie gehaltene Tage der Zeitfolge (Tagesindizes,
+	 * day_first > day_last: keine, siehe hold_days())
+	 */
+	int day_first;
+	int day_last;
+
         /* 
 	 * Array zum Speichern der Aufpunktlaengengrade der 
 	 * Trajektorie 
@@ -326,23 +1378,110 @@ struct state {
         /* Anzahl der in der Stationsliste enthaltenen Stationen */
 	int station_max; 
 
-        /* Struktur zum Speichern der Stationsinformationen */
-	struct station* station_list; 
+	/* 
+	 * Indizes der Stationen, die fuer die momentane Berechnungsposition
+	 * in Frage kommen. Die Liste wird fuer den Radius MAXR + MARGIN um 
+	 * die Position candidate_X aufgebaut und bleibt gueltig, solange sich
+	 * die Berechnungsposition um weniger als MARGIN von candidate_X 
+	 * entfernt hat (siehe update_candidates()).
+	 */
+	int* candidate;
+
+	/* Anzahl der Stationen in candidate (-1: Liste ungueltig) */
+	int candidate_max;
+
+	/* Position, um die die Kandidatenliste aufgebaut wurde */
+	double candidate_X[3];
+
+	/* Sicherheitsabstand MARGIN als Kosinus */
+	double cos_margin;
+
+	/* Anzahl der Neuaufbauten der Kandidatenliste */
+	int rebuild_count;
+
+	/* 
+	 * Stand der Kandidatenliste: wird bei jeder Aenderung erhoeht (auch
+	 * in build_grid()), gepackte Kerndaten mit anderem Stand sind nicht
+	 * mehr gueltig 
+	 */
+	int candidate_count;
+
+	/* Anzahl der Abfragen der Kandidatenliste */
+	int lookup_count;
+
+	/* 
+	 * Auswahl der naechsten Stationen (KNEAREST > 0, siehe 
+	 * update_nearest()): Anzahl KNEAREST, Zaehler der Stunden-Windfelder
+	 * beim letzten Aufbau der Kandidatenliste und Arbeitsfelder (4 * 
+	 * KNEAREST Stationsindizes bzw. KNEAREST Kosinus)
+	 */
+	int     nearest_max;
+	int     nearest_hour;
+	int*    nearest;
+	double* nearest_cos;
+
+	/* gepackte Kandidatendaten fuer den IDW-Kern */
+	struct kernel kernel;
+
+	/* Anzahl der bisher erzeugten Stunden-Windfelder (wind_current) */
+	int hour_count;
+
+	/* 
+	 * Daten-Windfelder (wind_data[0] frueher, wind_data[1] spaeter), 
+	 * verweisen in archive->timeline
+	 */
+	const struct field* wind_data[2]; 
+
+	/* 
+	 * Index des in Berechnungsrichtung zuletzt eingelesenen 
+	 * Daten-Windfeldes in archive->timeline
+	 */
+	int data;
 
 	/* 
-	 * Struktur zum Speichern der Daten-Windfeldern (wind_data[0] und
-	 * wind_data[1]) 
+	 * Zeiten der Stunden-Windfelder (Stunden seit dem 01.01.1970 00 Uhr
+	 * GMT) bei einer Windgitterdatei
 	 */
-	struct wind* wind_data; 
+	int hour[2];
 
         /* 
-	 * Struktur zum Speichern der Stunden-Windfelder (wind_current[0] 
-	 * und wind_current[1])
+	 * Stunden-Windfelder (wind_current[0] "zukuenftig", wind_current[1]
+	 * "momentan/vergangen"), enthalten nur Stationen mit Daten
+	 */
+	struct wind_field wind_current[2]; 
+
+	/* 
+	 * sin und cos der korrigierten Windrichtung (Richtung + ROT des 
+	 * Auftrags) fuer alle ganzzahligen Windrichtungen von 0 bis 360 Grad
+	 */
+	double dir_sin[361];
+	double dir_cos[361];
+
+	/* 
+	 * Gitter-Windfelder zu wind_current[0] und wind_current[1] und 
+	 * Geometrie der Gitter dieser Trajektorie (GRID > 0)
+	 */
+	struct grid*       grid[2];
+	struct grid_header grid_shape;
+
+	/* 
+	 * Delaunay-Triangulationen zu wind_current[0] und wind_current[1] 
+	 * und Dreieck des letzten Schritts in jeder (DELAUNAY = 1)
+	 */
+	struct mesh* mesh[2];
+	int          triangle[2];
+
+	/* 
+	 * Position jeder Station in wind_current[0] bzw. wind_current[1]
+	 * (-1: keine Daten)
 	 */
-	struct wind* wind_current; 
+	int* slot[2];
 
-        /* aktuelle interne Berechnungszeit */
-	struct date time; 
+        /* 
+	 * Startzeit in interner Zeitzone (GMT), Stunden seit dem 01.01.1970 
+	 * 00 Uhr 
+	 */
+	int time; 
 
 	/* 
 	 * zeitliche Differenz (h) zwischen letztem Daten-Windfeld und 
@@ -359,6 +1498,23 @@ struct state {
 	 */
 	double distance_per_step;
 
+	/* 
+	 * Schrittweitensteuerung (TOL > 0, siehe integrate_adaptive()): 
+	 * Schrittweite (h) fuer den naechsten Schritt, Anzahl der 
+	 * Weiterschaltungen der Stunden-Windfelder und Anzahl der 
+	 * angenommenen bzw. verworfenen Schritte
+	 */
+	double step_size;
+	int    advance_count;
+	int    step_count;
+	int    reject_count;
+
+	/*
+	 * Position des aktuellen Aufpunkts bei der Integration (siehe 
+	 * load_position()): (lo, la, 0) bzw. bei VECTOR der Ortsvektor
+	 */
+	double position[3];
+
 	/*
 	 * Minimalradius des Berechnungsgebiets angegeben als Kosinus des
 	 * Winkels der Ortvektoren des Kreismittelpunkts zum Kreisrand
@@ -372,90 +1528,334 @@ struct state {
 	double cos_max_r;
 };
 
-/* Struktur eines Stundenwindfelds */
-struct winddata {
-	struct date time;
-	struct wind* wind;
-	struct winddata* next;
-	struct winddata* prev;
-};
+/*
+ * Gruppe von Trajektorien, die im Gleichschritt (LOCKSTEP) Stunde fuer 
+ * Stunde gemeinsam fortgeschrieben werden (siehe calculate_lockstep()). 
+ * Alle Mitglieder haben dieselbe Richtung, SPEED und ROT und teilen sich 
+ * daher die Stunden-Windfelder, die einmal je Stunde im Zustand clock 
+ * erzeugt werden. Die gepackten Kandidaten der Mitglieder (siehe struct
+ * kernel) liegen verschraenkt: der k-te Kandidat des Mitglieds j steht in
+ * [k * lane_max + j], so dass der IDW-Kern ueber die Trajektorien 
+ * (Spuren) statt ueber die Stationen vektorisiert.
+ */
+struct lockstep {
+	struct state  clock;      /* Stunden-Windfelder der Gruppe */
+	struct state* member;     /* Zustaende der Mitglieder */
+	int           member_max; /* Anzahl der Mitglieder */
+	int           lane_max;   /* member_max aufgerundet auf LANES */
 
-/**********
- * MACROS *
- **********/
-#define rad2deg(f)	((f) * 180 / M_PI)
-#define deg2rad(f)	((f) * M_PI / 180)
+	/* 
+	 * Iterationsschritt der Gruppe, mit dem jedes Mitglied beginnt 
+	 * (Abstand der Startzeit zur Startzeit von clock)
+	 */
+	int*          offset;
+
+	/* 
+	 * Laenge der verschraenkten Felder (groesste Kandidatenanzahl aller 
+	 * Spuren) und Kandidatenanzahl (inkl. Fuellung) jeder Spur
+	 */
+	int           n;
+	int*          lane_n;
+
+	/* Verschraenkte Kandidatendaten (wie in struct kernel) */
+	double*       x;
+	double*       y;
+	double*       z;
+	double*       u1;
+	double*       v1;
+	double*       m1;
+	double*       u2;
+	double*       v2;
+	double*       m2;
+
+	/* 
+	 * Berechnungsposition (kartesisch) und Radien jeder Spur. Spuren 
+	 * ohne laufende Trajektorie haben cos_max_r = 2 (keine Station in 
+	 * Reichweite).
+	 */
+	double*       X[3];
+	double*       cos_min_r;
+	double*       cos_max_r;
+
+	/* Gewichtete Summen und letzter Windvektor jeder Spur */
+	struct idw_sum* sum;
+	double*         u;
+	double*         v;
+
+	/* Arbeitsfeld fuer idw_kernel_lanes_scalar() */
+	double*       acc;
+};
 
 /*
- * Markos zum Auslesen der verschiedenen Datentypen (int, float, string) aus
- * der Programmstartparameterstruktur (struct param)
+ * Schnittstelle einer Windquelle (siehe station_source und 
+ * windgrid_source). Die Trajektorienberechnung greift nur ueber diese 
+ * Funktionen auf die Winddaten zu.
  */
-#define get_int(p)     (assert(param[(p)].type == TYP_INT), param[(p)].u.i)
-#define get_float(p)   (assert(param[(p)].type == TYP_FLOAT), param[(p)].u.f)
-#define get_string(p)  (assert(param[(p)].type == TYP_STRING), param[(p)].u.s)
+struct wind_source {
 
-/* 
- * Makro zum kopieren der Werte der Zeitstruktur src in die Zeitstruktur 
- * dst 
- */
-#define time_copy(src, dst) do { \
-	(dst).year = (src).year; \
-	(dst).month = (src).month; \
-	(dst).day = (src).day; \
-	(dst).hour = (src).hour; \
-} while (0)
+	/* Einlesen bzw. Einblenden der Winddaten fuer alle Auftraege */
+	void (*open)(struct archive*, const struct job*, int);
 
-/* 
- * Makro zum vergleichen zweier Zeitstrukutren. Wenn die Zeiten gleich sind, 
- * ist -> time_equal == 0
- */
-#define time_equal(t1, t2)  ((t1).year == (t2).year && (t1).month == \
-                             (t2).month && (t1).day == (t2).day && \
-                             (t1).hour == (t2).hour)
+	/* Freigeben der Winddaten */
+	void (*close)(struct archive*);
 
-/**************
- * PROTOTYPES *
- **************/
+	/* Stunden-Windfelder zur Startzeit einer Trajektorie bereitstellen */
+	void (*begin)(struct state*);
 
-void             average_sum(double, double*, double*);
-void             calculate(struct state*);
-int              calculate_wind_vector(double, double*, double*, double*, 
+	/* Stunden-Windfelder um eine Zeitstunde weiterschalten */
+	void (*advance)(struct state*);
+
+	/* 
+	 * Windvektoren beider Stunden-Windfelder an einer Position als 
+	 * gewichtete Summen (Gewicht 0: keine Daten)
+	 */
+	void (*lookup)(struct state*, double*, struct idw_sum*);
+
+	/* Von einer Trajektorie gehaltene Winddaten freigeben (oder NULL) */
+	void (*end)(struct state*);
+};
+
+/* 
+ * Warteschlange der Auftraege eines Threads. Der Thread selbst entnimmt 
+ * Auftraege am Anfang (first), andere Threads stehlen am Ende (last).
+ */
+struct queue {
+#ifdef USE_PTHREAD
+	pthread_mutex_t lock;
+#endif
+	int first; /* Index des ersten noch nicht vergebenen Auftrags */
+	int last;  /* Index hinter dem letzten noch nicht vergebenen Auftrag */
+};
+
+/* Gemeinsame Daten aller Threads bei der Auftragsbearbeitung */
+struct pool {
+	struct archive*   archive;
+	const struct job* job;
+	int               thread_max;
+	int               unit_max; /* Anzahl der Auftraege bzw. Gruppen */
+	struct queue*     queue;
+
+	/* 
+	 * Erster Auftrag jeder Gruppe bei LOCKSTEP (NULL: die Warteschlangen
+	 * enthalten einzelne Auftraege statt Gruppen)
+	 */
+	const int*        group;
+};
+
+/* Startparameter eines Threads */
+struct worker {
+	struct pool* pool;
+	int          id;
+};
+
+/* Gemeinsame Daten der Threads beim Einlesen der Tagesdatensaetze */
+struct ingest {
+#ifdef USE_PTHREAD
+	pthread_mutex_t  lock;
+#endif
+	struct archive*  archive;
+	const int*       day;     /* einzulesende Tage (Tage seit 1970) */
+	int              day_max; /* Anzahl der einzulesenden Tage */
+	int              next;    /* Index des naechsten zu vergebenden Tages */
+	struct prefetch* buffer;  /* Puffer fuer jeden Tag */
+};
+
+/**********
+ * MACROS *
+ **********/
+#define rad2deg(f)	((f) * 180 / M_PI)
+#define deg2rad(f)	((f) * M_PI / 180)
+
+/*
+ * Markos zum Auslesen der verschiedenen Datentypen (int, float, string) aus
+ * der Programmstartparameterstruktur (struct param)
+ */
+#define get_int(p)     (assert(param[(p)].type == TYP_INT), param[(p)].u.i)
+#define get_float(p)   (assert(param[(p)].type == TYP_FLOAT), param[(p)].u.f)
+#define get_string(p)  (assert(param[(p)].type == TYP_STRING), param[(p)].u.s)
+
+/* 
+ * Makro zum Umrechnen einer Stunde in den Tag (jeweils seit dem 01.01.1970),
+ * in dem sie liegt (auch fuer Zeiten vor 1970 abgerundet)
+ */
+#define hour_to_day(h)  (((h) >= 0 ? (h) : (h) - 23) / 24)
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void             acquire_day(struct archive*, int);
+struct grid*     acquire_grid(struct state*);
+struct mesh*     acquire_mesh(struct state*);
+void             advance_stations(struct state*);
+void             advance_windgrid(struct state*);
+int              append_triangle(struct mesh*, int*, int, int, int);
+void             average_sum(double, double*, double*);
+void             begin_stations(struct state*);
+void             begin_windgrid(struct state*);
+int              blend_wind_vector(const struct idw_sum*, double, double*,
+                                   double*, const struct state*);
+struct grid*     build_grid(struct state*, unsigned long long);
+struct mesh*     build_mesh(const struct archive*, int*, int, 
+                            unsigned long long);
+void             calculate(struct state*);
+void             calculate_lockstep(struct lockstep*);
+int              calculate_step(struct state*, double, const double*, 
+                                double*);
+int              calculate_wind_vector(double, double*, double*, double*, 
                                        struct state*);
+int              check_lockstep(void);
+void             check_output_names(const struct job*, int);
 void             check_resolution(int, int);
-void             check_station_weight(struct state, struct wind*, double*, 
-                                      int, double*, double*, double*, 
-                                      double*, int);
+void             close_stations(struct archive*);
+void             close_windgrid(struct archive*);
+void             collect_days(const struct job*, int**, int*, int*);
+int              compare_int(const void*, const void*);
+int              compare_jobs(const void*, const void*);
+int              compare_strings(const void*, const void*);
 void             convert_geo_to_cartesian(double, double, double*);
-void             convert_timezone(struct state*);
+int              convert_timezone(const struct date*);
 void             copy_wind_current(struct state*);
-void             deviation_sum(struct wind*, double, double, double*, 
-                               double*, double*, int);
-double           distance_to_station_in_cos(int, double*, struct state);
-void             end_sum(struct wind*, double*, double*, double*, 
-                         double*, int);
-int              generate_output_filename(char*, size_t);
-int              get_amount_of_stations(struct state*);
-struct winddata* get_next_element(struct winddata*);
-struct winddata* get_next_wind_data(struct state*, struct winddata*);
-struct winddata* get_prev_element(struct winddata*);
-void             init_values(struct state*);
-struct winddata* init_wind_data(struct state*, struct winddata*);
-void             iterate(struct state*, struct winddata**);
-struct winddata* new_winddata(void);
+void             correct_wind(const struct state*, const struct report*,
+                              struct wind*);
+int              date_to_hours(const struct date*);
+void             decode_day(const struct archive*, int, struct prefetch*);
+void             drop_prefetch(struct prefetch*);
+void             end_stations(struct state*);
+int              find_field(struct state*, int, int);
+int              find_station(const struct archive*, int);
+int              find_stations(const struct station_index*, double*, 
+                               double, int*);
+void             free_day(struct archive*, int);
+void             free_grid(struct grid*);
+void             free_mesh(struct mesh*);
+int              generate_grid_filename(unsigned long long, char*, size_t);
+int              generate_input_filename(int, char*, size_t);
+int              generate_output_filename(const struct state*, char*, 
+                                          size_t);
+int              get_next_wind_data(struct state*, int);
+unsigned long long grid_key(const struct state*);
+int*             group_jobs(struct job*, int, int*);
+unsigned long long hash_bytes(unsigned long long, const void*, size_t);
+void             hold_days(struct state*, int, int);
+void             hours_to_date(int, struct date*);
+void             idw_kernel_avx2(const struct kernel*, const double*, 
+                                 double, double, struct idw_sum*);
+void             idw_kernel_filtered(struct kernel*, const double*, double,
+                                     double, double, struct idw_sum*);
+void             idw_kernel_lanes_avx2(struct lockstep*);
+void             idw_kernel_lanes_scalar(struct lockstep*);
+void             idw_kernel_scalar(const struct kernel*, const double*, 
+                                   double, double, struct idw_sum*);
+void             idw_kernel_sse2(const struct kernel*, const double*, 
+                                 double, double, struct idw_sum*);
+double           idw_weight(double, int);
+void             ingest_days(struct archive*, const int*, int);
+void*            ingest_main(void*);
+void             init_archive(struct archive*, const struct job*, int);
+void             init_grid_shape(struct state*);
+void             init_lockstep(struct lockstep*, struct archive*, 
+                              const struct job*, int);
+void             init_station_catalog(struct archive*);
+void             init_station_index(struct archive*);
+void             init_timeline(struct timeline*, int, int);
+void             init_values(struct state*, struct archive*, 
+                             const struct job*);
+int              init_wind_data(struct state*);
+int              integrate_adaptive(struct state*);
+int              integrate_step(struct state*, double);
+int              inside_circle(const struct mesh*, int, const double*);
+void             iterate(struct state*);
+void             load_day(struct archive*, int);
+void             load_position(struct state*);
+void             lookup_grid(const struct grid*, const double*, int, 
+                             struct idw_sum*);
+void             lookup_mesh(struct state*, const double*, int, 
+                             struct idw_sum*);
+void             lookup_stations(struct state*, double*, struct idw_sum*);
+void             lookup_windgrid(struct state*, double*, struct idw_sum*);
+void             map_archive(struct archive*);
 void             normalize_coords(struct state*);
-void             prepare_calculate(struct state*, struct winddata**);
+void             normalize_vector(double*);
+void             open_stations(struct archive*, const struct job*, int);
+void             open_windgrid(struct archive*, const struct job*, int);
+void             pack_archive(void);
+void             pack_candidates(struct state*);
+void             pack_lane(struct lockstep*, int);
+void             pack_nearest(struct state*, double*);
+void             prefetch_day(struct archive*, int);
+void             prefetch_job(struct archive*, const struct job*);
+void*            prefetch_main(void*);
+void             prepare_calculate(struct state*);
 void             print_output_file(const struct state*);
+char*            read_compressed(const char*, long*);
+void             read_day(struct archive*, int);
 void             read_env(struct param*);
-struct winddata* read_file(struct state*, char*);
-void             read_station_list(struct state*);
-void             read_wind_data(struct state*, struct winddata*);
+void             read_file(struct archive*, char*, int);
+struct grid*     read_grid(unsigned long long);
+struct job*      read_jobs(int*);
+void             read_packed_day(struct archive*, int);
+void             read_station_list(struct archive*);
+void             read_wind_data(struct archive*, const struct job*, int);
+void             release_day(struct archive*, int);
+void             release_grid(struct archive*, struct grid*);
+void             release_mesh(struct archive*, struct mesh*);
+void             reset_archive(struct archive*);
+void             reset_lockstep(struct lockstep*);
 void             reset_state(struct state*);
+void             retire_days(struct archive*, const struct job*);
+void             run_job(struct archive*, const struct job*);
+void             run_jobs(struct archive*, const struct job*, int, const int*,
+                          int);
+void             run_lockstep(struct archive*, const struct job*, int);
+int              sample_windgrid(const struct windgrid_header*, int, double,
+                                 double, double*, double*);
+int              scan_int(const char**, const char*, int*);
+int              select_nearest(const struct state*, const double*, int,
+                                int*, double*);
+void             select_idw_kernel(void);
+struct job*      series_jobs(struct job*, int*);
+void             splice_day(struct archive*, int, struct prefetch*);
 void             std_deviation(double, double*, double*);
-void             time_step_backward(struct date*);
-void             time_step_forward(struct date*);
+void             store_field(struct field*, int, int*, int*, char*);
+void             store_position(struct state*);
+struct job*      sweep_jobs(struct job*, int*);
+int              take_job(struct pool*, int);
+double           triple_product(const double*, const double*, 
+                                const double*);
+int              update_candidates(struct state*, double*);
+int              update_nearest(struct state*, double*);
+int              walk_mesh(const struct mesh*, const double*, int);
 void             wind_of_next_hour(struct state*);
-void             z_transformation_check(struct wind*, double, double, double, 
-                                        double, double, int);
+void*            worker_main(void*);
+
+/*
+ * Zur Laufzeit passend zum Prozessor ausgewaehlter IDW-Kern (siehe 
+ * select_idw_kernel())
+ */
+void (*idw_kernel)(const struct kernel*, const double*, double, double,
+                   struct idw_sum*) = idw_kernel_scalar;
+
+/* 
+ * Zur Laufzeit passend zum Prozessor ausgewaehlter IDW-Kern fuer den 
+ * Gleichschritt (siehe select_idw_kernel())
+ */
+void (*idw_kernel_lanes)(struct lockstep*) = idw_kernel_lanes_scalar;
+
+/* Windquelle Stationsmeldungen (METEO bzw. ARCHIVE, IDW) */
+const struct wind_source station_source = {
+	open_stations, close_stations, begin_stations, advance_stations,
+	lookup_stations, end_stations
+};
+
+/* Windquelle Windgitterdatei (WINDGRID, bilinear) */
+const struct wind_source windgrid_source = {
+	open_windgrid, close_windgrid, begin_windgrid, advance_windgrid,
+	lookup_windgrid, NULL
+};
+
+/* Zur Laufzeit ausgewaehlte Windquelle */
+const struct wind_source* wind_source = &station_source;
 
 /****************
  * MAINFUNCTION *
@@ -464,25 +1864,98 @@ void             z_transformation_check(struct wind*, double, double, double,
 int
 main(void)
 {
-	struct state state;
+	struct archive archive;
+	struct job*    job;
+	int            job_max;
+	int*           group = NULL;
+	int            group_max = 0;
 
 	/* Einlesen der uebergebenen Argumente */
 	read_env(param);
 
 	/* 
-	 * Initialisieren der Datenstruktur zum Abbilden des programminternen 
-	 * Berechnungsstatus
+	 * Wenn PACK angegeben ist, werden nur die Winddaten aus METEO in ein
+	 * Winddatenarchiv gepackt
 	 */
-	init_values(&state);
+	if (strlen(get_string(PACK)) > 0) {
+		pack_archive();
+		return (0);
+	}
 
-	/* Berechnen der Trajektorie */
-	calculate(&state);
+	/* Einlesen der zu berechnenden Trajektorien (Auftraege) */
+	job = read_jobs(&job_max);
 
-	/* Ausgeben der Trajektorie */
-	print_output_file(&state);
+	/* Vervielfachen der Auftraege fuer eine Zeitreihe */
+	if (strlen(get_string(SERIES)) > 0) {
+		job = series_jobs(job, &job_max);
+	}
 
-	/* Reservierte Speicherbereiche wieder freigeben */
-	reset_state(&state);
+	/* Vervielfachen der Auftraege fuer eine Parameterstudie */
+	if (strlen(get_string(SWEEP)) > 0) {
+		job = sweep_jobs(job, &job_max);
+	}
+
+	/* Jede Trajektorie muss in eine eigene Ausgabedatei geschrieben werden */
+	check_output_names(job, job_max);
+
+	/* Auswahl des IDW-Kerns fuer den vorhandenen Prozessor */
+	select_idw_kernel();
+
+	/* Auswahl der Windquelle */
+	if (strlen(get_string(WINDGRID)) > 0) {
+		wind_source = &windgrid_source;
+	}
+
+	/* 
+	 * Einlesen der Stationsinformationen und aller von den Auftraegen 
+	 * benoetigten Winddaten
+	 */
+	init_archive(&archive, job, job_max);
+
+	/* 
+	 * Gruppieren der Auftraege, deren Trajektorien im Gleichschritt 
+	 * berechnet werden
+	 */
+	if (check_lockstep()) {
+		group = group_jobs(job, job_max, &group_max);
+		printf("%i jobs in %i lockstep groups\n", job_max, group_max);
+	}
+
+	/* Berechnen und Ausgeben aller Trajektorien */
+	run_jobs(&archive, job, job_max, group, group_max);
+
+	/* Bei tageweisem Nachladen Umfang der eingelesenen Winddaten melden */
+	if (archive.cache.ref != NULL) {
+		printf("%i day files read (%i prefetched), at most %i days "
+		    "in memory, %i stalls\n", archive.cache.load_count, 
+		    archive.cache.prefetch_count, archive.cache.loaded_peak,
+		    archive.cache.stall_count);
+
+		if (archive.unknown_count > 0) {
+			printf("%i wind records of stations not in %s "
+			    "ignored\n", archive.unknown_count, 
+			    get_string(STATION));
+		}
+	}
+
+	/* Umfang der Triangulationen bzw. Gitter-Windfelder melden */
+	if ((wind_source == &station_source) && (get_int(DELAUNAY) != 0)) {
+		printf("%i Delaunay triangulations computed\n",
+		    archive.meshes.build_count);
+	}
+	else if ((wind_source == &station_source) && 
+	    (get_float(GRID) > 0.0)) {
+		printf("%i gridded wind fields computed (%li station "
+		    "searches), %i read from %s\n",
+		    archive.grids.build_count, archive.grids.search_count,
+		    archive.grids.read_count,
+		    strlen(get_string(GRIDCACHE)) > 0 ? 
+		    get_string(GRIDCACHE) : "GRIDCACHE");
+	}
+
+	reset_archive(&archive);
+	free(group);
+	free(job);
 
 	return (0);
 }
@@ -492,211 +1965,423 @@ main(void)
  ***************/
 
 /*
- * Mittelwerte bilden
- *
- * >> Mittelwert = Summe / Anzahl <<
- *
+ * Anfordern eines Tages der Zeitfolge (Tagesindex d in archive->timeline)
+ * durch eine Trajektorie. Ist der Tag noch nicht eingelesen, wird er 
+ * eingelesen (siehe load_day()).
  */
 void
-average_sum(double amount, double* u_average, double* v_average)
+acquire_day(struct archive* archive, int d)
 {
-	/* Wenn Stationen in Reichweite waren */
-	if (amount > 0) {
-		if (*u_average != 0) {
-			*u_average /=amount;
-		}
-		if (*v_average != 0) {
-			*v_average /=amount;
-		}
+	struct day_cache* cache = &archive->cache;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	cache->ref[d] += 1;
+
+	if ((cache->needed[d] != 0) && (cache->loaded[d] == 0)) {
+		load_day(archive, d);
 	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
 }
-	
-/* Berechnen der einzelnen Trajektorienaufpunkte */	
-void
-calculate(struct state *state)
+
+/*
+ * Anfordern des Gitter-Windfelds zum Stunden-Windfeld wind_current[0] 
+ * einer Trajektorie (GRID > 0). Gitter-Windfelder werden ueber ihren 
+ * Schluessel (siehe grid_key()) von allen Trajektorien gemeinsam genutzt.
+ * Ist das Gitter nicht im Speicher, wird es aus GRIDCACHE gelesen (siehe 
+ * read_grid()) oder berechnet (siehe build_grid()).
+ *
+ * Rueckgabewert ist das (nun von der Trajektorie gehaltene) Gitter-Windfeld
+ */
+struct grid*
+acquire_grid(struct state* state)
 {
-	struct winddata* winddata;
-	/* Alle Daten fuer die Berechnung zusammensammeln */
-	prepare_calculate(state, &winddata);
+	struct grid_cache* cache = &state->archive->grids;
+	struct grid*       grid;
+	struct grid*       prev;
+	unsigned long long key;
+	int                built;
+
+	key = grid_key(state);
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (prev = NULL, grid = cache->list; grid != NULL; 
+	    prev = grid, grid = grid->next) {
+		if (grid->key == key)
+			break;
+	}
 
+	/* Gefundenes Gitter an den Listenanfang stellen */
+	if (grid != NULL) {
+		if (grid->ref == 0)
+			cache->idle_count -= 1;
+		grid->ref += 1;
 
-	/* Start der Aufpunktberechnung */
-	for (state->point = 1; state->point <= state->point_max;
-	     state->point += 1) {
+		if (prev != NULL) {
+			prev->next = grid->next;
+			grid->next = cache->list;
+			cache->list = grid;
+		}
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+
+	if (grid != NULL)
+		return grid;
+
+	/* Lesen bzw. Berechnen ausserhalb der Sperre */
+	built = 0;
+	if ((grid = read_grid(key)) == NULL) {
+		grid = build_grid(state, key);
+		built = 1;
+	}
 
-		/* Kopieren der Koordinaten der letzten Aufpunktposition fuer
-		 * naechste Iteration */
-		state->lo[state->point] = state->lo[state->point - 1];
-		state->la[state->point] = state->la[state->point - 1];
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (prev = cache->list; prev != NULL; prev = prev->next) {
+		if (prev->key == key)
+			break;
+	}
 
-		/* Bis zum naechsten Aufpunkt iterieren */
-		iterate(state, &winddata);
+	/* 
+	 * Wenn ein anderer Thread dasselbe Gitter inzwischen eingetragen
+	 * hat, wird dessen Gitter verwendet
+	 */
+	if (prev != NULL) {
+		if (prev->ref == 0)
+			cache->idle_count -= 1;
+		prev->ref += 1;
+	}
+	else {
+		grid->ref = 1;
+		grid->next = cache->list;
+		cache->list = grid;
+
+		if (built)
+			cache->build_count += 1;
+		else
+			cache->read_count += 1;
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
 
-		/* Umrechnen auf geographischen Groessenbereich */
-		normalize_coords(state);
+	if (prev != NULL) {
+		free_grid(grid);
+		grid = prev;
 	}
+
+	return grid;
 }
 
 /*
- * Zeitliche und raeumliche Interpolation der beiden in wind_current 
- * gespeicherten Windfelder zu einem Windvektor (u,v) an der aktuelle 
- * Berechnungsposition (X)
+ * Anfordern der Delaunay-Triangulation zum Stunden-Windfeld 
+ * wind_current[0] einer Trajektorie (DELAUNAY = 1). Die Triangulation 
+ * haengt nur von den Stationen mit Daten ab und wird von allen 
+ * Trajektorien und Stunden mit denselben Stationen gemeinsam genutzt. Ist
+ * sie nicht im Speicher, wird sie berechnet (siehe build_mesh()).
  *
- * Rueckgabewert is
- *    0, wenn Vektor berechenet werden konnte
- *    1, wenn Vektor nicht berechnet werden konnte
+ * Rueckgabewert ist die (nun von der Trajektorie gehaltene) Triangulation
  */
-int
-calculate_wind_vector(double hour_diff, double* u, double* v, double X[],
-    struct state* state)
+struct mesh*
+acquire_mesh(struct state* state)
 {
-	int i;
-	double u_sum_wind1, v_sum_wind1, weight_sum_wind1;
-	double u_sum_wind2, v_sum_wind2, weight_sum_wind2;
-	double amount_wind1, amount_wind2;
-	double u_average_wind1, v_average_wind1;
-	double u_average_wind2, v_average_wind2;
-	double u_stddev_wind1, v_stddev_wind1;
-	double u_stddev_wind2, v_stddev_wind2;
-	double weight[state->station_max];
-
-	/* Speicher reservieren */
-	struct wind wind1_in_range[state->station_max];
-	struct wind wind2_in_range[state->station_max];
+	struct mesh_cache*       cache = &state->archive->meshes;
+	const struct wind_field* current = &state->wind_current[0];
+	struct mesh*             mesh;
+	struct mesh*             prev;
+	unsigned long long       key;
+	int*                     station;
+	int                      i;
+
+	station = malloc((current->n + 1) * sizeof(int));
+	for (i = 0; i < current->n; i++) {
+		station[i] = current->wind[i].s;
+	}
+	key = hash_bytes(14695981039346656037ULL, station, 
+	    current->n * sizeof(int));
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (prev = NULL, mesh = cache->list; mesh != NULL; 
+	    prev = mesh, mesh = mesh->next) {
+		if ((mesh->key == key) && (mesh->station_max == current->n) &&
+		    (memcmp(mesh->station, station, 
+		    current->n * sizeof(int)) == 0))
+			break;
+	}
 
-	/* Initialisieren */
-	u_sum_wind1 = v_sum_wind1 = weight_sum_wind1 = 0;
-	u_sum_wind2 = v_sum_wind2 = weight_sum_wind2 = 0;
-	amount_wind1 = amount_wind2 = 0;
-	u_average_wind1 = v_average_wind1 = 0;
-	u_average_wind2 = v_average_wind2 = 0;
+	/* Gefundene Triangulation an den Listenanfang stellen */
+	if (mesh != NULL) {
+		if (mesh->ref == 0)
+			cache->idle_count -= 1;
+		mesh->ref += 1;
 
-	for (i = 0; i < state->station_max; i++) {
+		if (prev != NULL) {
+			prev->next = mesh->next;
+			mesh->next = cache->list;
+			cache->list = mesh;
+		}
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
 
-		wind1_in_range[i].u = 0;
-		wind1_in_range[i].v = 0;
-		wind1_in_range[i].p = 0;
+	if (mesh != NULL) {
+		free(station);
+		return mesh;
+	}
 
-		wind2_in_range[i].u = 0;
-		wind2_in_range[i].v = 0;
-		wind2_in_range[i].p = 0;
+	/* Berechnen ausserhalb der Sperre */
+	mesh = build_mesh(state->archive, station, current->n, key);
 
-		weight[i] = 0;
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (prev = cache->list; prev != NULL; prev = prev->next) {
+		if ((prev->key == key) && (prev->station_max == current->n) &&
+		    (memcmp(prev->station, station, 
+		    current->n * sizeof(int)) == 0))
+			break;
 	}
 
 	/* 
-	 * Speichern der Winddaten von Stationen in Reichweite und 
-	 * aufsummieren der gewichteten Werte
-	 *
-	 * >> Summe = sum(xi) <<
-	 *
+	 * Wenn ein anderer Thread dieselbe Triangulation inzwischen 
+	 * eingetragen hat, wird dessen Triangulation verwendet
 	 */
-	for (i = 0; i < state->station_max; i++) {
-		
-		check_station_weight(*state, wind1_in_range, X, i, weight, 
-		    &u_average_wind1, &v_average_wind1, 
-		    &amount_wind1, 0);
-		
-		check_station_weight(*state, wind2_in_range, X, i, weight, 
-		    &u_average_wind2, &v_average_wind2, 
-		    &amount_wind2, state->station_max);
+	if (prev != NULL) {
+		if (prev->ref == 0)
+			cache->idle_count -= 1;
+		prev->ref += 1;
+	}
+	else {
+		mesh->ref = 1;
+		mesh->next = cache->list;
+		cache->list = mesh;
+		cache->build_count += 1;
 	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+
+	if (prev != NULL) {
+		free_mesh(mesh);
+		mesh = prev;
+	}
+
+	return mesh;
+}
+
+/*
+ * Windquelle Stationsmeldungen: Weiterschalten der Stunden-Windfelder um
+ * eine Zeitstunde. Ist das naechste Daten-Windfeld erreicht, wird das 
+ * Zeitfenster wind_data verschoben.
+ */
+void
+advance_stations(struct state* state)
+{
+	if (state->job.trace > 0)
+		state->diff += 1;
+	else
+		state->diff -= 1;
 
 	/* 
-	 * Wenn maximale Standardabweichung angegeben ist, werden alle 
-	 * Stationen, die in u oder v eine groessere Abweichung vom u- 
-	 * bzw. v-Mittelwert besitzen, aus der Berechnung genommen
+	 * Umkopieren des vorher "zukuenftigen" Stunden-Windfeldes 
+	 * (wind_current[0]) als "momentanes/vergangenes" Stunden-Windfeld
+	 * (wind_curren[1]) 
 	 */
-	if (get_float(STDDEVIATION) > 0.0) {
+	copy_wind_current(state);
 
-		/* Mittelwerte bilden
-		 *
-		 * >> Mittelwert = Summe / Anzahl <<
-		 *
+	/* Wenn das naechste Daten-Windfeld erreicht ist */
+	if ((state->diff == state->data_diff) || (state->diff == -1)) { 
+
+		/* 
+		 * Verschieben des Zeitfensters (wind_data) um 
+		 * state->delta_diff in Berechnungsrichtung (lese neues 
+		 * Daten-Windfeld ein)
+		 */
+		state->data = get_next_wind_data(state, state->data);
+		
+		/* 
+		 * Ueberpruefen, ob die angegeben zeitliche Datenaufloesung 
+		 * mit vorhandeneer Datenaufloesung uebereinstimmt
 		 */
-		average_sum(amount_wind1,
-		    &u_average_wind1, &v_average_wind1);
-
-		average_sum(amount_wind2,
-		    &u_average_wind2, &v_average_wind2);
-
-		/* Werte zuruecksetzen */
-		u_stddev_wind1 = v_stddev_wind1 = 0;
-		u_stddev_wind2 = v_stddev_wind2 = 0;
-		amount_wind1 = amount_wind2 = 0;
-
-		/*
-		 * Errechnen der Summe der Abweichungsquadrate
-		 *
-		 * >> QSumme = sum((xi - Mittelwert) *(xi - Mittelwert)) <<
-		 *
+		check_resolution(get_int(RES), state->data_diff);
+		
+		/* 
+		 * Setze den Zeitunterschied (state->diff) zum Daten-Windfeld
+		 * auf 0 
 		 */
-		for (i = 0; i < state->station_max; i++) {
+		if (state->job.trace > 0)
+			state->diff = 0;
+		else
+			state->diff = state->data_diff - 1;
+	}
+	
+	/* 
+	 * Generieren des naechsten "zukuenftigen" Stunden-Windfeldes 
+	 * (wind_current[0]) 
+	 */
+	wind_of_next_hour(state);
+}
 
-			deviation_sum(wind1_in_range, 
-			    u_average_wind1, v_average_wind1, 
-			    &u_stddev_wind1, &v_stddev_wind1, 
-			    &amount_wind1, i);
+/*
+ * Windquelle Windgitterdatei: Weiterschalten der Stunden-Windfelder um 
+ * eine Zeitstunde
+ */
+void
+advance_windgrid(struct state* state)
+{
+	state->hour[1] = state->hour[0];
 
-			deviation_sum(wind2_in_range, 
-			    u_average_wind2, v_average_wind2, 
-			    &u_stddev_wind2, &v_stddev_wind2, 
-			    &amount_wind2, i);
-		}
+	if (state->job.trace > 0)
+		state->hour[0] += 1;
+	else
+		state->hour[0] -= 1;
+}
 
-		/* 
-		 * Wenn Wetterstation in Reichweite sind, kann Standardab-
-		 * weichung berechnet werden.
-		 *
-		 * >> Standardabweichung = wurzel(QSumme / Anzahl) <<
-		 *
-		 */
-		std_deviation(amount_wind1, &u_stddev_wind1, 
-		    &v_stddev_wind1);
+/*
+ * Anhaengen eines Dreiecks mit den Ecken a, b, c (ohne Nachbarn) an die 
+ * Dreiecke einer entstehenden Triangulation; das Feld wird bei Bedarf 
+ * auf capacity vergroessert
+ *
+ * Rueckgabewert ist der Index des neuen Dreiecks
+ */
+int
+append_triangle(struct mesh* mesh, int* capacity, int a, int b, int c)
+{
+	struct triangle* t;
 
-		std_deviation(amount_wind2, &u_stddev_wind2, 
-		    &v_stddev_wind2);
+	if (mesh->triangle_max == *capacity) {
+		*capacity *= 2;
+		mesh->triangle = realloc(mesh->triangle, 
+		    *capacity * sizeof(struct triangle));
+	}
 
-		/* Werte mit zu grosser Abweichung rauswerfen */
-		for (i = 0; i < state->station_max; i++) {
+	t = &mesh->triangle[mesh->triangle_max];
+	t->v[0] = a;
+	t->v[1] = b;
+	t->v[2] = c;
+	t->n[0] = t->n[1] = t->n[2] = -1;
 
-			z_transformation_check(wind1_in_range, 
-			    u_average_wind1, v_average_wind1, 
-			    u_stddev_wind1, v_stddev_wind1, 
-			    get_float(STDDEVIATION), i);
+	return mesh->triangle_max++;
+}
 
-			z_transformation_check(wind2_in_range, 
-			    u_average_wind2, v_average_wind2, 
-			    u_stddev_wind2, v_stddev_wind2, 
-			    get_float(STDDEVIATION), i);
+/*
+ * Mittelwerte bilden
+ *
+ * >> Mittelwert = Summe / Anzahl <<
+ *
+ */
+void
+average_sum(double amount, double* u_average, double* v_average)
+{
+	/* Wenn Stationen in Reichweite waren */
+	if (amount > 0) {
+		if (*u_average != 0) {
+			*u_average /=amount;
+		}
+		if (*v_average != 0) {
+			*v_average /=amount;
 		}
 	}
+}
 	
-	/* Berechnen des gemittelten gewichteten Windes */
-	for (i = 0; i < state->station_max; i++) {
-
-		end_sum(wind1_in_range, &u_sum_wind1, &v_sum_wind1,
-		    weight, &weight_sum_wind1, i);
-	
-		end_sum(wind2_in_range, &u_sum_wind2, &v_sum_wind2, 
-		    weight, &weight_sum_wind2, i);
+/* Berechnen der einzelnen Trajektorienaufpunkte */	
+/*
+ * Windquelle Stationsmeldungen: Einlesen der ersten beiden Daten-
+ * Windfelder und Erzeugen des ersten Stunden-Windfeldes zur Startzeit
+ */
+void
+begin_stations(struct state* state)
+{
+	/* Geometrie der Gitter-Windfelder */
+	if (get_float(GRID) > 0.0) {
+		init_grid_shape(state);
 	}
 
+	/*
+	 * Einlesen der ersten fuer die Berechnung benoetigten 2 
+	 * Daten-Windfelder in die Datenstruktur state->wind_data
+	 */
+	state->data = init_wind_data(state);
+
+	/* Ueberpruefen, ob die angegebenen Datensatzaufloesung korrekt ist */
+	check_resolution(get_int(RES), state->data_diff);
+
 	/* 
-	 * Zeitliches Wichten:
-	 * Je nach Iterationsfortschritt entfernt sich die momentane
-	 * Berechnungszeit vom zweiten Windfeld in wind_current hin zum 
-	 * ersten Windfeld int wind_current. Zwischen den beiden Windfeldern 
-	 * in wind_current besteht immer genau 1 Zeitstunde Unterschied.
-	 * hour_diff gibt den Anteil an, der waerend der Iterationen schon
-	 * vergangen ist. Die zeitliche Wichtung erfolgt ueber hour_diff
-	 *
-	 * wind_current[1]|------------------------------|wind_current[0]
-	 *                0         |                    1
-	 *                       hour_diff=0.3
+	 * Erzeugung des ersten interpolierten Stunden-Windfeldes 
+	 * (state->wind_current) zur momentanen Berechnunszeitstunde aus den 
+	 * Daten-Windfeldern 
+	 */
+	wind_of_next_hour(state);
+}
+
+/*
+ * Windquelle Windgitterdatei: Stunden-Windfeld zur Startzeit. Die 
+ * Startzeit muss in der Datei liegen.
+ */
+void
+begin_windgrid(struct state* state)
+{
+	const struct windgrid_header* header = 
+	    (const struct windgrid_header*)state->archive->windgrid;
+
+	if ((state->time < header->first) || (state->time > header->first + 
+	    (header->hour_max - 1) * header->step)) {
+		printf("%s: start time not covered!\n", get_string(WINDGRID));
+		exit(1);
+	}
+
+	state->hour[0] = state->hour[1] = state->time;
+}
+
+/*
+ * Zeitliche Interpolation der gewichteten Summen sum beider Stunden-
+ * Windfelder (siehe calculate_wind_vector()) zu einem Windvektor (u,v)
+ *
+ * Rueckgabewert ist
+ *    0, wenn Vektor berechenet werden konnte
+ *    1, wenn Vektor nicht berechnet werden konnte (u und v bleiben 
+ *       unveraendert)
+ */
+int
+blend_wind_vector(const struct idw_sum* sum, double hour_diff, double* u,
+    double* v, const struct state* state)
+{
+	double u_sum_wind1, v_sum_wind1, weight_sum_wind1;
+	double u_sum_wind2, v_sum_wind2, weight_sum_wind2;
+
+	u_sum_wind1 = sum->u[0];
+	v_sum_wind1 = sum->v[0];
+	weight_sum_wind1 = sum->weight[0];
+	u_sum_wind2 = sum->u[1];
+	v_sum_wind2 = sum->v[1];
+	weight_sum_wind2 = sum->weight[1];
+
+	/* 
+	 * Zeitliches Wichten:
+	 * Je nach Iterationsfortschritt entfernt sich die momentane
+	 * Berechnungszeit vom zweiten Windfeld in wind_current hin zum 
+	 * ersten Windfeld int wind_current. Zwischen den beiden Windfeldern 
+	 * in wind_current besteht immer genau 1 Zeitstunde Unterschied.
+	 * hour_diff gibt den Anteil an, der waerend der Iterationen schon
+	 * vergangen ist. Die zeitliche Wichtung erfolgt ueber hour_diff
+	 *
+	 * wind_current[1]|------------------------------|wind_current[0]
+	 *                0         |                    1
+	 *                       hour_diff=0.3
 	 */
 	if ((hour_diff == 0)) {
-		if (get_int(TRACE) > 0) {
+		if (state->job.trace > 0) {
 			if (weight_sum_wind1 != 0) {
 				*u = u_sum_wind1 / weight_sum_wind1;
 				*v = v_sum_wind1 / weight_sum_wind1;
@@ -716,7 +2401,7 @@ calculate_wind_vector(double hour_diff, double* u, double* v, double X[],
 		if ((weight_sum_wind1 != 0) &&
 		    (weight_sum_wind2 != 0)) {
 
-			if (get_int(TRACE) > 0) {
+			if (state->job.trace > 0) {
 				*u = (1.0 - hour_diff) * 
 				    (u_sum_wind1 / weight_sum_wind1) + 
 				    hour_diff * 
@@ -746,672 +2431,4270 @@ calculate_wind_vector(double hour_diff, double* u, double* v, double X[],
 		}
 	}
 }
-		
-/* Ueberpruefen, ob angegebene zeitliche Aufloesung der Winddaten zutrifft */
-void
-check_resolution(int res, int DeltaT)
-{
-	if ((res != 0) && (res != DeltaT)) {
-		printf("Error: resolution of wind data is (%i)\n", DeltaT);
-		exit (1);
-	}
-	else if (DeltaT > 24){
-		printf("Error: resolution of wind data is (%i)\n", DeltaT);
-		exit (1);
-	}
-}
 
 /*
- * Ueberpruefen, ob Station in Reichweite ist und Berechnung ihres
- * oertlichen Wichtungsfaktors
+ * Berechnen des Gitter-Windfelds zum Stunden-Windfeld wind_current[0] 
+ * einer Trajektorie mit dem IDW-Kern (MAXR, MINR, STDDEVIATION und 
+ * WEIGHTMODE wie in calculate_wind_vector()). Gitterpunkte ohne Station 
+ * in Reichweite werden in der Abdeckungsmaske mit 0 markiert. Damit das
+ * Gitter nur von wind_current[0] abhaengt, wird wind_current[1] waehrend
+ * der Berechnung ausgeblendet. Ist GRIDCACHE angegeben, wird das Gitter 
+ * dort gespeichert (ueber eine temporaere Datei, so dass gleichzeitig 
+ * laufende Programme nur vollstaendige Gitter lesen).
+ *
+ * Rueckgabewert ist das neue Gitter-Windfeld
  */
-void
-check_station_weight(struct state state, struct wind* wind_in_range,
-    double* X, int i, double* weight, double* u_sum, double* v_sum,
-    double* amount, int offset)
+struct grid*
+build_grid(struct state* state, unsigned long long key)
 {
-	double val;
+	const struct grid_header* shape = &state->grid_shape;
+	struct grid*   grid;
+	struct idw_sum sum;
+	float*         u;
+	float*         v;
+	unsigned char* mask;
+	int*           slot;
+	int            i, j, k, n, count, ib, jb, current;
+	int            rebuild, lookup;
+	long           search = 0;
+	double         X[3], radius;
+	char           name[MAXLINE], temp[MAXLINE];
+	FILE*          fh;
+
+	count = shape->lo_max * shape->la_max;
+
+	grid = calloc(1, sizeof(struct grid));
+	grid->key = key;
+	grid->size = sizeof(struct grid_header) + 
+	    count * (2 * sizeof(float) + 1);
+	grid->data = malloc(grid->size);
+
+	memcpy(grid->data, shape, sizeof(struct grid_header));
+	((struct grid_header*)grid->data)->key = key;
+
+	grid->header = (const struct grid_header*)grid->data;
+	grid->u = u = (float*)(grid->data + sizeof(struct grid_header));
+	grid->v = v = u + count;
+	grid->mask = mask = (unsigned char*)(v + count);
+
+	/* wind_current[1] ausblenden (keine Station eingetragen) */
+	slot = state->slot[1];
+	current = state->wind_current[1].n;
+	state->slot[1] = malloc((state->station_max + 1) * sizeof(int));
+	for (k = 0; k < state->station_max; k++)
+		state->slot[1][k] = -1;
+	state->wind_current[1].n = 0;
+	state->candidate_max = -1;
 
-	/* Wenn keine Daten vorhanden sind */
-	if (state.wind_current[offset+i].p == 0)
-		return;
-	
-	/* Berechnen der Distanz von Berechnungspunkt und Station i */
-	val = distance_to_station_in_cos(i, X, state);
-	
-	/* Wenn Station naeher als min_r */
-	if (val > state.cos_min_r) {
-		val = state.cos_min_r;
-	}
-	
-	/* Wenn Station innerhalb von max_r */
-	if (val > state.cos_max_r) {
-		
-                /* Wichtung mit 1 / r^2 */
-		weight[i] = 1 / (acos(val) * acos(val)); 
-		
-		wind_in_range[i].p = 1;
-		
-		wind_in_range[i].u = state.wind_current[offset+i].u * 
-		    weight[i];
-		
-		wind_in_range[i].v = state.wind_current[offset+i].v * 
-		    weight[i];
-		
-		/* 
-		 * Aufsummieren der Winddaten fuer spaetere
-		 * Mittelwertberechnung
-		 */
-		*u_sum += wind_in_range[i].u;
-		*v_sum += wind_in_range[i].v;
-		*amount += 1;
-	}
-}
+	/* 
+	 * Die Suchen fuer das gemeinsam genutzte Gitter werden in 
+	 * archive->grids gezaehlt, nicht bei der Trajektorie
+	 */
+	rebuild = state->rebuild_count;
+	lookup = state->lookup_count;
 
-/*
- * Umrechnen der geographischen Positionsangabe in Rad (longitude,
- * latitude) in einen katesischen Ortsvektor (X)
- */
-void
-convert_geo_to_cartesian(double longitude, double latitude, double X[])
-{
-	X[0] = cos(latitude) * cos(longitude);
-	X[1] = cos(latitude) * sin(longitude);
-	X[2] = sin(latitude);
-}
+	/* 
+	 * Die Kandidatenliste wird je Block von GRIDBLOCK x GRIDBLOCK
+	 * Gitterpunkten um die Blockmitte aufgebaut; ihr Radius MAXR plus
+	 * Blockseite enthaelt alle Stationen im Radius MAXR um jeden
+	 * Gitterpunkt des Blocks. Bei Auswahl der naechsten Stationen wird
+	 * sie wie bei der Trajektorie je Gitterpunkt aktualisiert.
+	 */
+	radius = state->job.maxr / RE + GRIDBLOCK * shape->step;
+
+	for (jb = 0; jb < shape->la_max; jb += GRIDBLOCK) {
+		for (ib = 0; ib < shape->lo_max; ib += GRIDBLOCK) {
+			convert_geo_to_cartesian(shape->lo_first + 
+			    (ib + GRIDBLOCK / 2) * shape->step,
+			    shape->la_first + 
+			    (jb + GRIDBLOCK / 2) * shape->step, X);
+
+			if (get_int(KNEAREST) == 0) {
+				state->candidate_max = find_stations(
+				    &state->archive->index, X, radius, 
+				    state->candidate);
+				state->candidate_count += 1;
+				search += 1;
+				pack_candidates(state);
+			}
 
-/* Umrechnung von externer Zeitzone in interne Zeitzone (GMT) */
-void
-convert_timezone(struct state* state) {
+			for (k = 0; k < GRIDBLOCK * GRIDBLOCK; k++) {
+				i = ib + k % GRIDBLOCK;
+				j = jb + k / GRIDBLOCK;
+				n = j * shape->lo_max + i;
 
-	int i;
+				if ((i >= shape->lo_max) || 
+				    (j >= shape->la_max))
+					continue;
+
+				convert_geo_to_cartesian(shape->lo_first + 
+				    i * shape->step, shape->la_first + 
+				    j * shape->step, X);
+
+				if (get_int(KNEAREST) > 0) {
+					update_nearest(state, X);
+					pack_nearest(state, X);
+				}
+
+				if (get_float(STDDEVIATION) > 0.0) {
+					idw_kernel_filtered(&state->kernel, 
+					    X, state->cos_min_r, 
+					    state->cos_max_r, 
+					    get_float(STDDEVIATION), &sum);
+				}
+				else {
+					idw_kernel(&state->kernel, X, 
+					    state->cos_min_r, 
+					    state->cos_max_r, &sum);
+				}
 
-	if (get_int(ZONEDIFF) < 0) {
-		for (i = 0; i > get_int(ZONEDIFF); i--) {
-			time_step_backward(&state->time);
+				mask[n] = (sum.weight[0] != 0);
+				u[n] = mask[n] ? sum.u[0] / sum.weight[0] : 0;
+				v[n] = mask[n] ? sum.v[0] / sum.weight[0] : 0;
+			}
 		}
 	}
-	else {
-		for (i = 0; i < get_int(ZONEDIFF); i++) {
-			time_step_forward(&state->time);
+
+	/* 
+	 * wind_current[1] wieder einblenden und Kandidatenliste der 
+	 * Trajektorie neu aufbauen lassen
+	 */
+	free(state->slot[1]);
+	state->slot[1] = slot;
+	state->wind_current[1].n = current;
+	state->candidate_max = -1;
+
+	/* Suchen der Auswahl der naechsten Stationen (KNEAREST > 0) */
+	search += state->rebuild_count - rebuild;
+	state->rebuild_count = rebuild;
+	state->lookup_count = lookup;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&state->archive->grids.lock);
+#endif
+	state->archive->grids.search_count += search;
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&state->archive->grids.lock);
+#endif
+
+	/* Speichern in GRIDCACHE */
+	if (strlen(get_string(GRIDCACHE)) > 0) {
+		generate_grid_filename(key, name, MAXLINE);
+		snprintf(temp, MAXLINE, "%s%016llx.%i.%lx", 
+		    get_string(GRIDCACHE), key, (int)getpid(), 
+		    (unsigned long)grid);
+
+		if (!(fh = fopen(temp, "wb"))) {
+			printf("Couldn't open file %s!\n", temp);
+			exit(1);
 		}
-	}
-}
 
-/*
- * Umkopieren des Stundenwindfeldes in wind_current (wind_current[0] ->
- * wind_current[1]). 
- */
-void
-copy_wind_current(struct state* state)
-{
-	int j;
+		if (fwrite(grid->data, 1, grid->size, fh) != 
+		    (size_t)grid->size) {
+			printf("Couldn't write file %s!\n", temp);
+			exit(1);
+		}
 
-	for (j = 0; j < state->station_max; j++) {
-		
-		state->wind_current[state->station_max + j].u =
-		    state->wind_current[j].u;
-		
-		state->wind_current[state->station_max + j].v =
-		    state->wind_current[j].v;
-		
-		state->wind_current[state->station_max + j].p =
-		    state->wind_current[j].p; 
+		if ((fclose(fh) != 0) || (rename(temp, name) != 0)) {
+			printf("Couldn't write file %s!\n", name);
+			exit(1);
+		}
 	}
+
+	return grid;
 }
 
 /*
- * Errechnen der Summe der Abweichungsquadrate
- *
- * >> QSumme = sum((xi - Mittelwert) *(xi - Mittelwert)) <<
+ * Berechnen der Delaunay-Triangulation auf der Kugel fuer die Stationen 
+ * station (station_max Stationsindizes, gehen in die Triangulation 
+ * ueber). Die Triangulation beginnt mit MESHGHOST Hilfspunkten (Tetraeder,
+ * eine Ecke gegenueber dem Schwerpunkt der Stationen), so dass sie immer 
+ * die ganze Kugel ueberdeckt. Die Stationen werden nacheinander eingefuegt
+ * (Bowyer-Watson): Alle Dreiecke, in deren Umkreis die neue Station 
+ * liegt, werden entfernt und ihr Rand mit der Station verbunden. Das 
+ * erste dieser Dreiecke wird ab dem zuletzt erzeugten Dreieck gesucht 
+ * (siehe walk_mesh()). Stationen an derselben Position wie eine 
+ * eingefuegte Station werden uebergangen.
  *
+ * Rueckgabewert ist die (noch von keiner Trajektorie gehaltene) 
+ * Triangulation
  */
-void
-deviation_sum(struct wind* wind_in_range, 
-    double u_average, double v_average,
-    double* u_stddev, double* v_stddev,
-    double* amount, int i)
+struct mesh*
+build_mesh(const struct archive* archive, int* station, int station_max,
+    unsigned long long key)
 {
-	/* Wenn Daten vorhanden sind */
-	if (wind_in_range[i].p != 0) {
+	static const int face[4][3] = {
+		{ 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 1 }, { 1, 3, 2 }
+	};
+	struct mesh*     mesh;
+	struct triangle* triangle;
+	double           e[3], f[3], g[3], a, len;
+	double*          P;
+	int*             mark;
+	int*             cavity;
+	int*             first;
+	int              capacity, mark_max, cavity_max, head, last, fresh;
+	int              i, j, k, c, o, u, v;
+
+	mesh = malloc(sizeof(struct mesh));
+	mesh->key = key;
+	mesh->ref = 0;
+	mesh->station_max = station_max;
+	mesh->station = station;
+	mesh->vertex = malloc((MESHGHOST + station_max) * sizeof(int));
+	mesh->X = malloc(3 * (MESHGHOST + station_max) * sizeof(double));
+	mesh->next = NULL;
+
+	capacity = 64;
+	mesh->triangle_max = 0;
+	mesh->triangle = malloc(capacity * sizeof(struct triangle));
+
+	/* Hilfspunkt 0 gegenueber dem Schwerpunkt der Stationen */
+	e[0] = e[1] = e[2] = 0;
+	for (k = 0; k < station_max; k++) {
+		for (i = 0; i < 3; i++)
+			e[i] -= archive->station_list[station[k]].X[i];
+	}
+	len = sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+	if (len < 1e-9) {
+		e[0] = e[1] = 0;
+		e[2] = len = 1;
+	}
+	for (i = 0; i < 3; i++)
+		e[i] /= len;
+
+	/* Orthonormalbasis e, f, g */
+	if (fabs(e[0]) < 0.5) {
+		f[0] = 0;
+		f[1] = e[2];
+		f[2] = -e[1];
+	}
+	else {
+		f[0] = -e[2];
+		f[1] = 0;
+		f[2] = e[0];
+	}
+	len = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	for (i = 0; i < 3; i++)
+		f[i] /= len;
+	g[0] = e[1] * f[2] - e[2] * f[1];
+	g[1] = e[2] * f[0] - e[0] * f[2];
+	g[2] = e[0] * f[1] - e[1] * f[0];
+
+	/* Hilfspunkte 1 bis 3 gleichmaessig um e (regelmaessiges Tetraeder) */
+	for (k = 0; k < MESHGHOST; k++) {
+		a = 2 * M_PI * k / 3;
+		for (i = 0; i < 3; i++) {
+			mesh->X[3 * k + i] = (k == 0) ? e[i] : -e[i] / 3 + 
+			    2 * M_SQRT2 / 3 * (cos(a) * f[i] + sin(a) * g[i]);
+		}
+		mesh->vertex[k] = -1;
+	}
+	mesh->vertex_max = MESHGHOST;
+
+	/* Flaechen des Tetraeders, von aussen gegen den Uhrzeigersinn */
+	for (k = 0; k < 4; k++) {
+		if (triple_product(&mesh->X[3 * face[k][0]], 
+		    &mesh->X[3 * face[k][1]], &mesh->X[3 * face[k][2]]) > 0)
+			append_triangle(mesh, &capacity, face[k][0], 
+			    face[k][1], face[k][2]);
+		else
+			append_triangle(mesh, &capacity, face[k][0], 
+			    face[k][2], face[k][1]);
+	}
+	for (k = 0; k < 4; k++) {
+		for (i = 0; i < 3; i++) {
+			u = mesh->triangle[k].v[(i + 1) % 3];
+			v = mesh->triangle[k].v[(i + 2) % 3];
+
+			for (c = 0; c < 4; c++) {
+				for (j = 0; j < 3; j++) {
+					if ((mesh->triangle[c].v[j] == v) &&
+					    (mesh->triangle[c].v[(j + 1) % 3]
+					    == u))
+						mesh->triangle[k].n[i] = c;
+				}
+			}
+		}
+	}
+
+	mark_max = capacity;
+	mark = calloc(mark_max, sizeof(int));
+	cavity = malloc(mark_max * sizeof(int));
+	first = malloc((MESHGHOST + station_max) * sizeof(int));
+	last = 0;
+
+	for (k = 0; k < station_max; k++) {
+		v = mesh->vertex_max;
+		P = &mesh->X[3 * v];
+		for (i = 0; i < 3; i++)
+			P[i] = archive->station_list[station[k]].X[i];
+
+		last = walk_mesh(mesh, P, last);
+		triangle = &mesh->triangle[last];
+
+		/* Station an derselben Position wie eine Ecke */
+		for (i = 0; i < 3; i++) {
+			c = 3 * triangle->v[i];
+			if (mesh->X[c] * P[0] + mesh->X[c + 1] * P[1] + 
+			    mesh->X[c + 2] * P[2] > 1 - 1e-12)
+				break;
+		}
+		if (i < 3)
+			continue;
+
+		mesh->vertex[v] = station[k];
+		mesh->vertex_max += 1;
+
+		/* 
+		 * Dreiecke, in deren Umkreis die Station liegt (vom 
+		 * enthaltenden Dreieck aus zusammenhaengend), werden markiert
+		 */
+		cavity[0] = last;
+		mark[last] = 1;
+		for (cavity_max = 1, head = 0; head < cavity_max; head++) {
+			for (i = 0; i < 3; i++) {
+				u = mesh->triangle[cavity[head]].n[i];
+
+				if ((mark[u] == 0) && 
+				    inside_circle(mesh, u, P)) {
+					mark[u] = 1;
+					cavity[cavity_max++] = u;
+				}
+			}
+		}
 
-		*u_stddev += (wind_in_range[i].u - u_average) *
-		    (wind_in_range[i].u - u_average);
+		/* Rand der entfernten Dreiecke mit der Station verbinden */
+		fresh = mesh->triangle_max;
+		for (head = 0; head < cavity_max; head++) {
+			c = cavity[head];
+
+			for (i = 0; i < 3; i++) {
+				o = mesh->triangle[c].n[i];
+				if (mark[o] != 0)
+					continue;
+
+				j = append_triangle(mesh, &capacity, 
+				    mesh->triangle[c].v[(i + 1) % 3],
+				    mesh->triangle[c].v[(i + 2) % 3], v);
+				mesh->triangle[j].n[2] = o;
+				first[mesh->triangle[j].v[0]] = j;
+
+				for (u = 0; u < 3; u++) {
+					if (mesh->triangle[o].n[u] == c)
+						mesh->triangle[o].n[u] = j;
+				}
+			}
+		}
 
-		*v_stddev += (wind_in_range[i].v - v_average) *
-		    (wind_in_range[i].v - v_average);
+		/* 
+		 * Neue Dreiecke untereinander verbinden: Die Kante (b, v) 
+		 * des Dreiecks (a, b, v) gehoert zum Dreieck (b, ., v)
+		 */
+		for (j = fresh; j < mesh->triangle_max; j++) {
+			u = first[mesh->triangle[j].v[1]];
+			mesh->triangle[j].n[0] = u;
+			mesh->triangle[u].n[1] = j;
+		}
+		last = fresh;
+
+		if (mark_max < capacity) {
+			mark = realloc(mark, capacity * sizeof(int));
+			cavity = realloc(cavity, capacity * sizeof(int));
+			memset(mark + mark_max, 0, 
+			    (capacity - mark_max) * sizeof(int));
+			mark_max = capacity;
+		}
+	}
 
-		*amount += 1;
+	/* Entfernte Dreiecke austragen (cavity: neuer Index) */
+	for (j = k = 0; j < mesh->triangle_max; j++) {
+		cavity[j] = k;
+		if (mark[j] == 0)
+			mesh->triangle[k++] = mesh->triangle[j];
 	}
-}
+	for (j = 0; j < k; j++) {
+		for (i = 0; i < 3; i++)
+			mesh->triangle[j].n[i] = cavity[mesh->triangle[j].n[i]];
+	}
+	mesh->triangle_max = k;
+	mesh->triangle = realloc(mesh->triangle, 
+	    (k + 1) * sizeof(struct triangle));
 
-/*
- * Errechnen des Skalarprodukts von zwei Ortsvektoren. Fuer dieses
- * Programm liegen alle Punkte (Ortsvektoren) auf einer Kugel-
- * oberflaeche mit dem Radius 1 (programminterne Berechnungen
- * behandeln die Erdkugel als Einheitskugel)
- *
- * -> Der Betrag aller Ortsvekoren (Kugelmittelpunkt bis Kugel-
- *    oberflaeche) ist 1
- *
- * Rueckgabewert ist das Skalarprodukt bzw. der Kosinus des Winkels
- * zwischen den beiden Ortsvektoren.
- */
-double
-distance_to_station_in_cos(int j, double X[], struct state state)
-{
-	return (state.station_list[j].X[0] * X[0] +
-	    state.station_list[j].X[1] * X[1] +
-	    state.station_list[j].X[2] * X[2]);
+	free(mark);
+	free(cavity);
+	free(first);
+
+	return mesh;
 }
 
-/* Berechnen des gemittelten gewichteten Windes */
 void
-end_sum(struct wind* wind_in_range, double* u_sum, double* v_sum,
-    double* weight, double* weight_sum, int i)
+calculate(struct state *state)
 {
-	/* Wenn Daten vorhanden sind */
-	if (wind_in_range[i].p != 0) {
+	/* Alle Daten fuer die Berechnung zusammensammeln */
+	prepare_calculate(state);
+
+
+	/* Start der Aufpunktberechnung */
+	for (state->point = 1; state->point <= state->point_max;
+	     state->point += 1) {
 
-		/* Aufaddieren der Windvektoren */
-		*u_sum      += wind_in_range[i].u;
-		*v_sum      += wind_in_range[i].v;
-		*weight_sum += weight[i];
+		/* Kopieren der Koordinaten der letzten Aufpunktposition fuer
+		 * naechste Iteration */
+		state->lo[state->point] = state->lo[state->point - 1];
+		state->la[state->point] = state->la[state->point - 1];
+
+		/* Bis zum naechsten Aufpunkt iterieren */
+		iterate(state);
+
+		/* 
+		 * Umrechnen auf geographischen Groessenbereich (bei VECTOR 
+		 * liegen die Koordinaten schon darin)
+		 */
+		if (get_int(VECTOR) == 0)
+			normalize_coords(state);
 	}
 }
 
-/* 
- * Generieren eines Ausgabedateinamens aus den gesetzten Programmparametern 
- *
- * Rueckgabewert ist der generierte Dateinamen
+/*
+ * Berechnen aller Trajektorien einer Gruppe im Gleichschritt (siehe 
+ * struct lockstep). Die Iterationsschritte laufen in Zeitrichtung ab der
+ * Startzeit von clock; jedes Mitglied beginnt mit dem Schritt seiner 
+ * Startzeit und endet wie in calculate() nach point_max Aufpunkten oder 
+ * wenn kein Windvektor berechnet werden konnte. Zu jeder vollen Stunde 
+ * werden die gemeinsamen Stunden-Windfelder einmal weitergeschaltet; je
+ * Schritt werden die Windvektoren aller laufenden Trajektorien in einem 
+ * Aufruf des IDW-Kerns berechnet. Jede Trajektorie durchlaeuft dieselben
+ * Rechenschritte wie mit iterate() und ist daher bitgleich.
  */
-int
-generate_output_filename(char* filename, size_t size)
+void
+calculate_lockstep(struct lockstep* group)
 {
-	/* Wenn Rueckwaertstrajektorie */
-	if (get_int(TRACE) < 0) { 
-		return snprintf(filename, size, 
-		    "%sB%04i%02i%02i_%02i.trj",
-		    get_string(OUTPUT), get_int(YYYY), 
-		    get_int(MM), get_int(DD), 
-		    get_int(HH));
+	struct state* clock = &group->clock;
+	struct state* state;
+	double        X[3];
+	double        hour_diff;
+	int           i, j, k, step, iteration, done;
+
+	/* Stunden-Windfeld zur Startzeit der Gruppe bereitstellen */
+	wind_source->begin(clock);
+
+	/* Trajektorien ohne Aufpunkte sind sofort fertig */
+	for (i = done = 0; i < group->member_max; i++) {
+		if (group->member[i].point_max == 0) {
+			group->member[i].point = 1;
+			done++;
+		}
 	}
+
+	for (step = 0; done < group->member_max; step++) {
+		iteration = step % get_int(IPERH);
+		hour_diff = (double)iteration / (double)get_int(IPERH);
+
+		/* 
+		 * Zur vollen Stunde Weiterschalten der gemeinsamen Stunden-
+		 * Windfelder, die Mitglieder verweisen auf die von clock
+		 */
+		if (iteration == 0) {
+			wind_source->advance(clock);
+
+			for (i = 0; i < group->member_max; i++) {
+				state = &group->member[i];
+				for (k = 0; k < 2; k++) {
+					state->wind_current[k] = 
+					    clock->wind_current[k];
+					state->slot[k] = clock->slot[k];
+				}
+				state->hour_count = clock->hour_count;
+			}
+		}
+
+		/* Positionen und Kandidaten aller laufenden Trajektorien */
+		for (i = 0; i < group->member_max; i++) {
+			state = &group->member[i];
+
+			/* Start der Trajektorie */
+			if ((state->point == 0) && (step == group->offset[i])) {
+				state->point = 1;
+				state->lo[1] = state->lo[0];
+				state->la[1] = state->la[0];
+			}
+			if ((state->point == 0) || 
+			    (state->point > state->point_max))
+				continue;
+
+			convert_geo_to_cartesian(state->lo[state->point], 
+			    state->la[state->point], X);
+
+			for (k = 0; k < 3; k++)
+				group->X[k][i] = X[k];
+			group->cos_min_r[i] = state->cos_min_r;
+			group->cos_max_r[i] = state->cos_max_r;
+
+			update_candidates(state, X);
+			pack_lane(group, i);
+		}
+
+		/* Gewichtete Summen aller Spuren in einem Durchlauf */
+		for (i = group->n = 0; i < group->member_max; i++) {
+			if (group->lane_n[i] > group->n)
+				group->n = group->lane_n[i];
+		}
+		idw_kernel_lanes(group);
+
+		/* Iterationsschritt jeder laufenden Trajektorie */
+		for (i = 0; i < group->member_max; i++) {
+			state = &group->member[i];
+
+			if ((state->point == 0) || 
+			    (state->point > state->point_max))
+				continue;
+
+			/* Iterationsschritt innerhalb des Aufpunkts */
+			j = (step - group->offset[i]) % get_int(IPERPOINT);
+
+			/* 
+			 * Wenn kein Windvektor berechnet werden konnte, endet
+			 * die Trajektorie nach diesem Schritt (mit dem letzten
+			 * Windvektor wie in iterate())
+			 */
+			if (blend_wind_vector(&group->sum[i], hour_diff, 
+			    &group->u[i], &group->v[i], state) == 1) {
+				state->point_max = state->point;
+				j = get_int(IPERPOINT) - 1;
+			}
+
+			state->lo[state->point] = state->lo[state->point] + 
+			    state->distance_per_step * group->u[i] / 
+			    cos(state->la[state->point]);
 			
-	/* Wenn Vorwaertstrajektorie */
-	else { 
-		return snprintf(filename, size, 
-		    "%sF%04i%02i%02i_%02i.trj",
-		    get_string(OUTPUT), get_int(YYYY), 
-		    get_int(MM), get_int(DD), 
-		    get_int(HH));
+			state->la[state->point] = state->la[state->point] + 
+			    state->distance_per_step * group->v[i];
+
+			if (j < get_int(IPERPOINT) - 1)
+				continue;
+
+			/* Aufpunkt erreicht */
+			normalize_coords(state);
+			state->point += 1;
+
+			if (state->point <= state->point_max) {
+				state->lo[state->point] = 
+				    state->lo[state->point - 1];
+				state->la[state->point] = 
+				    state->la[state->point - 1];
+			}
+			else {
+				pack_lane(group, i);
+				done++;
+			}
+		}
 	}
 }
 
-/* 
- * Zaehlen der in der Stationsinformationsdatei enthaltenen
- * Stationen und rueckgabe der Anzahl als Rueckgabewer
+/*
+ * Versatz dy eines Iterationsschritts mit dem Windvektor an der Position
+ * y zum Stundenanteil hour_diff (siehe calculate_wind_vector()). Die 
+ * Position ist (lo, la, 0) bzw. bei Integration im Raum der 
+ * Einheitsvektoren (VECTOR) ein Vektor, der fuer die Windberechnung auf 
+ * die Einheitskugel projiziert wird. Der Versatz liegt dann in der 
+ * Tangentialebene, aufgespannt von den Einheitsvektoren nach Osten 
+ * (-sin lo, cos lo, 0) und Norden (-sin la cos lo, -sin la sin lo, 
+ * cos la), die ohne Winkelfunktionen aus dem Ortsvektor folgen. An den 
+ * Polen gilt die Richtung von lo = 0.
  *
  * Rueckgabewert ist
- *    0, wenn keine Stationen gefunden wurden
- *    Anzahl, wenn Stationen gefunden wurden
+ *    0, wenn der Versatz berechnet werden konnte
+ *    1, wenn kein Windvektor berechnet werden konnte
  */
 int
-get_amount_of_stations(struct state* state)
+calculate_step(struct state* state, double hour_diff, const double y[],
+    double dy[])
 {
-	int   i, c;
-	FILE* fh;
+	double u, v, r, co, si;
+	double X[3];
 
-	/* Ueberpruefen, ob Datei existiert */
-	if (!(fh = fopen(get_string(STATION), "r"))) {
-		printf("Couldn't open file %s!\n", get_string(STATION));
-		exit(1);
+	if (get_int(VECTOR) == 0) {
+		convert_geo_to_cartesian(y[0], y[1], X);
+	}
+	else {
+		X[0] = y[0];
+		X[1] = y[1];
+		X[2] = y[2];
+		normalize_vector(X);
 	}
 
-	/* Zaehlen der Stationseintraege in der Datei */
-	i = 0;
-	while ((c = getc(fh)) && (c != EOF)) {
-		if (c == '\n') 
-			++i;
+	if (calculate_wind_vector(hour_diff, &u, &v, X, state) == 1)
+		return 1;
+
+	if (get_int(VECTOR) == 0) {
+		dy[0] = state->distance_per_step * u / cos(y[1]);
+		dy[1] = state->distance_per_step * v;
+		dy[2] = 0;
+		return 0;
 	}
 
-	/* Datei schliessen */
-	fclose(fh);
+	/* cos lo, sin lo und cos la */
+	r = sqrt(X[0] * X[0] + X[1] * X[1]);
+	co = (r > 1e-15) ? X[0] / r : 1;
+	si = (r > 1e-15) ? X[1] / r : 0;
 
-	/* Rueckgabe der Stationsanzahl */
-	return i;
-}
+	dy[0] = state->distance_per_step * (-u * si - v * X[2] * co);
+	dy[1] = state->distance_per_step * (u * co - v * X[2] * si);
+	dy[2] = state->distance_per_step * v * r;
 
-/* Zum naechsten Listenelement in der Kette springen
- * Rueckgabewert ist das naechste Listenelement
- */
-struct winddata* 
-get_next_element(struct winddata* winddata)
-{
-	do {
-		winddata = winddata->next;
-		if (winddata == NULL) {
-			printf("get_next_element: end of list!\n");
-			exit(1);
-		}
-	} while (winddata->wind == NULL);
-	
-	return winddata;
+	return 0;
 }
 
 /*
- * Verschieben des Winddatenfeldes wind_data um data_diff bis zum
- * naechstn gueltigen Datenblock
+ * Zeitliche und raeumliche Interpolation der beiden in wind_current 
+ * gespeicherten Windfelder zu einem Windvektor (u,v) an der aktuelle 
+ * Berechnungsposition (X)
+ *
+ * Rueckgabewert is
+ *    0, wenn Vektor berechenet werden konnte
+ *    1, wenn Vektor nicht berechnet werden konnte
  */
-struct winddata*
-get_next_wind_data(struct state* state, struct winddata* winddata)
+int
+calculate_wind_vector(double hour_diff, double* u, double* v, double X[],
+    struct state* state)
 {
-	struct date time_dummy;
-	int   i;
+	struct idw_sum sum;
 
-	time_dummy.year = winddata->time.year;
-	time_dummy.month = winddata->time.month;
-	time_dummy.day = winddata->time.day;
-	time_dummy.hour = winddata->time.hour;
+	/* Windvektoren beider Stunden-Windfelder von der Windquelle */
+	wind_source->lookup(state, X, &sum);
+
+	return blend_wind_vector(&sum, hour_diff, u, v, state);
+}
+		
+/*
+ * Pruefen, ob die Auftraege im Gleichschritt (LOCKSTEP) berechnet werden
+ * koennen: nur mit Stationsmeldungen, IDW ohne Ausreisserfilter und mit 
+ * festen Euler-Schritten
+ *
+ * Rueckgabewert ist
+ *    1, wenn LOCKSTEP gesetzt ist und verwendet werden kann
+ *    0, sonst
+ */
+int
+check_lockstep(void)
+{
+	return (get_int(LOCKSTEP) > 0) && (wind_source == &station_source) &&
+	    (get_float(GRID) <= 0.0) && (get_int(DELAUNAY) == 0) &&
+	    (get_int(KNEAREST) <= 0) && (get_float(STDDEVIATION) <= 0.0) &&
+	    (get_int(INTEGRATOR) == 0) && (get_float(TOL) <= 0.0) &&
+	    (get_int(VECTOR) == 0);
+}
+
+/*
+ * Ueberpruefen, ob alle Auftraege (nach dem Vervielfachen durch SERIES und
+ * SWEEP) verschiedene Ausgabedateien erzeugen. Andernfalls wuerden
+ * Ergebnisse stillschweigend ueberschrieben.
+ */
+void
+check_output_names(const struct job* job, int job_max)
+{
+	struct state* state;
+	char**        name;
+	int           i;
+
+	state = calloc(1, sizeof(struct state));
+	name = malloc(job_max * sizeof(char*));
+
+	for (i = 0; i < job_max; i++) {
+		state->job = job[i];
+		name[i] = malloc(MAXLINE);
+		if (generate_output_filename(state, name[i], MAXLINE) >= 
+		    MAXLINE) {
+			printf("Linebuffer too small!\n");
+			exit(1);
+		}
+	}
+
+	qsort(name, job_max, sizeof(char*), compare_strings);
+
+	for (i = 1; i < job_max; i++) {
+		if (strcmp(name[i - 1], name[i]) == 0) {
+			printf("Error: several jobs write output file %s!\n",
+			    name[i]);
+			exit(1);
+		}
+	}
+
+	for (i = 0; i < job_max; i++) {
+		free(name[i]);
+	}
+	free(name);
+	free(state);
+}
+
+/* Ueberpruefen, ob angegebene zeitliche Aufloesung der Winddaten zutrifft */
+void
+check_resolution(int res, int DeltaT)
+{
+	if ((res != 0) && (res != DeltaT)) {
+		printf("Error: resolution of wind data is (%i)\n", DeltaT);
+		exit (1);
+	}
+	else if (DeltaT > 24){
+		printf("Error: resolution of wind data is (%i)\n", DeltaT);
+		exit (1);
+	}
+}
+
+/*
+ * Windquelle Stationsmeldungen: Freigeben der von allen Auftraegen 
+ * gemeinsam genutzten Eingabedaten
+ */
+void
+close_stations(struct archive* archive)
+{
+	struct grid* grid;
+	struct mesh* mesh;
+	int          i;
+
+	for (i = 0; i < archive->timeline.hour_max; i++) {
+		if ((archive->timeline.mapped == NULL) || 
+		    (archive->timeline.mapped[i] == 0))
+			free(archive->timeline.field[i].report);
+	}
+	free(archive->timeline.field);
+	free(archive->timeline.prev);
+	free(archive->timeline.mapped);
+
+	if (archive->cache.ref != NULL) {
+#ifdef USE_PTHREAD
+		/* Vorauslade-Thread beenden */
+		if (archive->cache.prefetch != 0) {
+			pthread_mutex_lock(&archive->cache.lock);
+			archive->cache.stop = 1;
+			pthread_cond_signal(&archive->cache.wake);
+			pthread_mutex_unlock(&archive->cache.lock);
+
+			pthread_join(archive->cache.thread, NULL);
+			pthread_cond_destroy(&archive->cache.wake);
+			pthread_cond_destroy(&archive->cache.done);
+		}
+		pthread_mutex_destroy(&archive->cache.lock);
+#endif
+		drop_prefetch(&archive->cache.slot[0]);
+		drop_prefetch(&archive->cache.slot[1]);
+		free(archive->cache.ref);
+		free(archive->cache.loaded);
+	}
+
+	/* Gitter-Windfelder freigeben */
+	while ((grid = archive->grids.list) != NULL) {
+		archive->grids.list = grid->next;
+		free_grid(grid);
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_destroy(&archive->grids.lock);
+#endif
+
+	/* Delaunay-Triangulationen freigeben */
+	while ((mesh = archive->meshes.list) != NULL) {
+		archive->meshes.list = mesh->next;
+		free_mesh(mesh);
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_destroy(&archive->meshes.lock);
+#endif
+
+	/* Winddatenarchiv ausblenden */
+	if (archive->pack != NULL) {
+#ifdef USE_MMAP
+		munmap(archive->pack, archive->pack_size);
+#else
+		free(archive->pack);
+#endif
+	}
+	free(archive->station_list);
+	free(archive->catalog.slot);
+	free(archive->catalog.same);
+	free(archive->index.first);
+	free(archive->index.station);
+}
+
+/* Windquelle Windgitterdatei: Ausblenden der Windgitterdatei */
+void
+close_windgrid(struct archive* archive)
+{
+#ifdef USE_MMAP
+	munmap(archive->windgrid, archive->windgrid_size);
+#else
+	free(archive->windgrid);
+#endif
+}
+
+/*
+ * Erstellen einer Liste der von einem Auftrag benoetigten Tagesdatensaetze.
+ * Die Tage (Tage seit dem 01.01.1970) werden an das Feld day (Groesse size)
+ * angehaengt, day_max ist die Anzahl der gespeicherten Tage.
+ */
+void
+collect_days(const struct job* job, int** day, int* day_max, int* size)
+{
+	int d, first, last;
+	int res = get_int(RES);
+
+	/* 
+	 * Wenn Aufloesung der Wetterdaten (Zeitabstand) nicht festgelegt
+	 * wurde, nimm als Maximalabstand RESMAX an
+	 */
+	if (res == 0) {
+		res = RESMAX;
+	}
+
+	/* 
+	 * Berechnungszeitraum in interner Zeitzone (GMT), vor der Startzeit
+	 * bzw. nach der Endzeit erweitert um die maximale zeitliche 
+	 * Differenz zweier Datensaetze, um ein Fehlen von Datensaetzen bei
+	 * der spaeteren zeitlichen Interpolation zu verhindern
+	 */
+	first = last = convert_timezone(&job->time);
+
+        /* Wenn Rueckwaertstrajektorie */
+	if (job->trace < 0) { 
+		first += job->trace - res;
+		last += res;
+	}
 
-	winddata = get_next_element(winddata);
-	
-	state->data_diff = 0;
-	
         /* Wenn Vorwaertstrajektorie */
-	if (get_int(TRACE) > 0) { 
-		while (!time_equal(time_dummy, winddata->time)) {
-			time_step_forward(&time_dummy);
-			state->data_diff += 1;
+	else { 
+		first -= res;
+		last += job->trace + res;
+	}
+
+	/* Alle Tage des Berechnungszeitraums in der Liste (day) speichern */
+	for (d = hour_to_day(first); d <= hour_to_day(last); d++) {
+
+		/* Wenn Tagesliste zu klein ist */
+		if (*day_max == *size) {
+			*size *= 2;
+			*day = realloc(*day, *size * sizeof(int));
+		}
+
+		(*day)[*day_max] = d;
+		*day_max += 1;
+	}
+}
+
+/*
+ * Vergleichsfunktion fuer qsort() zum Sortieren von Ganzzahlen 
+ * (Stationsindizes)
+ *
+ * Rueckgabewert ist <0, 0 oder >0, wenn a kleiner, gleich oder groesser b 
+ * ist
+ */
+int
+compare_int(const void* a, const void* b)
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+/*
+ * Vergleichsfunktion fuer qsort() zum Sortieren der Auftraege fuer den 
+ * Gleichschritt: nach Richtung, SPEED und ROT (die die Stunden-Windfelder
+ * bestimmen), dann nach Startzeit in Berechnungsrichtung und zuletzt nach
+ * den uebrigen Startparametern
+ *
+ * Rueckgabewert ist <0, 0 oder >0, wenn a vor, gleich oder nach b 
+ * einzuordnen ist
+ */
+int
+compare_jobs(const void* a, const void* b)
+{
+	const struct job* p = a;
+	const struct job* q = b;
+	int               s, t;
+
+	if ((p->trace > 0) != (q->trace > 0))
+		return (p->trace > 0) ? -1 : 1;
+	if (p->speed != q->speed)
+		return (p->speed < q->speed) ? -1 : 1;
+	if (p->rot != q->rot)
+		return (p->rot < q->rot) ? -1 : 1;
+
+	/* Vorwaerts aufsteigende, rueckwaerts absteigende Startzeit */
+	s = date_to_hours(&p->time);
+	t = date_to_hours(&q->time);
+	if (s != t)
+		return ((s < t) == (p->trace > 0)) ? -1 : 1;
+
+	if (p->trace != q->trace)
+		return (abs(p->trace) > abs(q->trace)) ? -1 : 1;
+	if (p->lo != q->lo)
+		return (p->lo < q->lo) ? -1 : 1;
+	if (p->la != q->la)
+		return (p->la < q->la) ? -1 : 1;
+	if (p->maxr != q->maxr)
+		return p->maxr - q->maxr;
+	return p->minr - q->minr;
+}
+
+/*
+ * Vergleichsfunktion fuer qsort() zum Sortieren von Zeichenketten 
+ * (Ausgabedateinamen)
+ *
+ * Rueckgabewert ist <0, 0 oder >0, wenn a vor, gleich oder nach b 
+ * einzuordnen ist
+ */
+int
+compare_strings(const void* a, const void* b)
+{
+	return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/*
+ * Umrechnen der geographischen Positionsangabe in Rad (longitude,
+ * latitude) in einen katesischen Ortsvektor (X)
+ */
+void
+convert_geo_to_cartesian(double longitude, double latitude, double X[])
+{
+	X[0] = cos(latitude) * cos(longitude);
+	X[1] = cos(latitude) * sin(longitude);
+	X[2] = sin(latitude);
+}
+
+/* 
+ * Umrechnung von externer Zeitzone in interne Zeitzone (GMT)
+ *
+ * Rueckgabewert ist die Zeit in GMT als Stunden seit dem 01.01.1970 00 Uhr
+ */
+int
+convert_timezone(const struct date* time) {
+
+	return date_to_hours(time) + get_int(ZONEDIFF);
+}
+
+/*
+ * Umkopieren des Stundenwindfeldes in wind_current (wind_current[0] ->
+ * wind_current[1]). Die beiden Felder werden nur vertauscht, 
+ * wind_current[0] wird anschliessend von wind_of_next_hour() neu erzeugt.
+ */
+void
+copy_wind_current(struct state* state)
+{
+	struct wind_field field;
+	int*              slot;
+	struct grid*      grid;
+	struct mesh*      mesh;
+	int               t;
+
+	field = state->wind_current[1];
+	state->wind_current[1] = state->wind_current[0];
+	state->wind_current[0] = field;
+
+	slot = state->slot[1];
+	state->slot[1] = state->slot[0];
+	state->slot[0] = slot;
+
+	grid = state->grid[1];
+	state->grid[1] = state->grid[0];
+	state->grid[0] = grid;
+
+	mesh = state->mesh[1];
+	state->mesh[1] = state->mesh[0];
+	state->mesh[0] = mesh;
+
+	t = state->triangle[1];
+	state->triangle[1] = state->triangle[0];
+	state->triangle[0] = t;
+}
+
+/*
+ * Korrigieren einer Windmeldung mit den Parametern des Auftrags: Umrechnen
+ * von Knoten in m/s (DATAUNIT), Geschwindigkeitsfaktor SPEED und 
+ * Richtungskorrektur ROT (aus den Tabellen dir_sin, dir_cos)
+ */
+void
+correct_wind(const struct state* state, const struct report* report,
+    struct wind* wind)
+{
+	double wind_speed, wind_direction;
+
+	wind_speed = report->speed;
+	
+	/* 
+	 * Wenn Windgeschwindigkeiten in Knoten angegeben sind -> muss in 
+	 * m\s umgerechnet werden
+	 */
+	if (state->archive->station_list[report->s].knots) {
+		wind_speed = wind_speed * MILE / 3.6;
+	}
+	
+	/* 
+	 * Anpassung der Bodenwindgeschwindigkeit auf mittlere 
+	 * Transportgeschwindigkeit in der Mischungsschicht durch 
+	 * Windgeschwindigkeitsfaktor
+	 */
+	wind_speed = wind_speed * state->job.speed;
+
+	wind->s = report->s;
+
+	if ((report->direction >= 0) && (report->direction <= 360)) {
+		wind->u = wind_speed * state->dir_sin[report->direction];
+		wind->v = wind_speed * state->dir_cos[report->direction];
+	}
+	else {
+		wind_direction = report->direction;
+		wind_direction += state->job.rot;
+		wind_direction = deg2rad(wind_direction);
+		wind->u = wind_speed * sin(wind_direction);
+		wind->v = wind_speed * cos(wind_direction);
+	}
+}
+
+/*
+ * Umrechnen einer Zeitangabe (gregorianischer Kalender) in die Anzahl der
+ * Stunden seit dem 01.01.1970 00 Uhr. Die Tageszaehlung erfolgt ueber eine
+ * geschlossene Formel in 400-Jahres-Zyklen (Jahr beginnt am 1. Maerz, so
+ * dass der Schalttag am Jahresende liegt).
+ */
+int
+date_to_hours(const struct date* time)
+{
+	int y, era, yoe, doy, doe;
+
+	y = time->year - (time->month <= 2);
+	era = (y >= 0 ? y : y - 399) / 400;
+	yoe = y - era * 400;                                    /* [0, 399] */
+	doy = (153 * (time->month + (time->month > 2 ? -3 : 9)) + 2) / 5 + 
+	    time->day - 1;                                      /* [0, 365] */
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;          /* [0, 146096] */
+
+	return (era * 146097 + doe - 719468) * 24 + time->hour;
+}
+
+/*
+ * Einlesen der Winddaten eines Tages (Tage seit dem 01.01.1970) in den 
+ * Puffer slot statt in archive->timeline. Stationsliste und Winddaten-
+ * archiv werden nur gelesen, so dass mehrere Tage gleichzeitig (in 
+ * verschiedenen Threads) eingelesen werden koennen.
+ */
+void
+decode_day(const struct archive* archive, int day, struct prefetch* slot)
+{
+	struct archive local;
+
+	/* Zeitfolge aus den 24 Stunden des Puffers */
+	memset(&local, 0, sizeof(struct archive));
+	local.station_max = archive->station_max;
+	local.station_list = archive->station_list;
+	local.catalog = archive->catalog;
+	local.pack = archive->pack;
+	local.pack_size = archive->pack_size;
+	local.timeline.first = day * 24;
+	local.timeline.hour_max = 24;
+	local.timeline.field = slot->field;
+	local.timeline.mapped = slot->mapped;
+
+	read_day(&local, day);
+
+	slot->unknown_count = local.unknown_count;
+}
+
+/*
+ * Verwerfen des Inhalts eines Vorausladepuffers
+ */
+void
+drop_prefetch(struct prefetch* slot)
+{
+	int i;
+
+	for (i = 0; i < 24; i++) {
+		if (slot->mapped[i] == 0)
+			free(slot->field[i].report);
+		slot->field[i].report = NULL;
+		slot->field[i].n = 0;
+		slot->mapped[i] = 0;
+	}
+
+	slot->day = -1;
+	slot->state = PREFETCH_EMPTY;
+}
+
+/*
+ * Windquelle Stationsmeldungen: Freigeben aller von einer Trajektorie 
+ * gehaltenen Tage, Gitter-Windfelder und Triangulationen
+ */
+void
+end_stations(struct state* state)
+{
+	hold_days(state, 0, -1);
+	release_grid(state->archive, state->grid[0]);
+	release_grid(state->archive, state->grid[1]);
+	release_mesh(state->archive, state->mesh[0]);
+	release_mesh(state->archive, state->mesh[1]);
+}
+
+/*
+ * Suchen des naechsten Daten-Windfeldes ab Stunde i der Zeitfolge 
+ * (einschliesslich) in Richtung step (1: vorwaerts, -1: rueckwaerts). Bei
+ * tageweisem Nachladen werden die durchsuchten Tage von der Trajektorie 
+ * gehalten (siehe hold_days()).
+ *
+ * Rueckgabewert ist
+ *    der Index des Daten-Windfeldes in archive->timeline
+ *    -1, wenn kein Daten-Windfeld gefunden wurde
+ */
+int
+find_field(struct state* state, int i, int step)
+{
+	const struct timeline* timeline = &state->archive->timeline;
+	int d, k;
+
+	while ((i >= 0) && (i < timeline->hour_max)) {
+
+		/* Wenn alle Tage vorab eingelesen wurden */
+		if (state->archive->cache.ref == NULL) {
+			return (step > 0) ? timeline->next[i] : 
+			    timeline->prev[i];
+		}
+
+		/* Tag der Stunde i anfordern */
+		d = i / 24;
+		if (state->day_first < 0)
+			hold_days(state, d, d);
+		else if (d < state->day_first)
+			hold_days(state, d, state->day_last);
+		else if (d > state->day_last)
+			hold_days(state, state->day_first, d);
+
+		/* Die Nachschlagetabellen reichen nur bis zum Tagesende */
+		k = (step > 0) ? timeline->next[i] : timeline->prev[i];
+		if (k >= 0)
+			return k;
+
+		/* Weitersuchen im folgenden bzw. vorherigen Tag */
+		i = (step > 0) ? (d + 1) * 24 : d * 24 - 1;
+	}
+
+	return -1;
+}
+
+/*
+ * Suchen einer Station im Stationskatalog ueber ihre Stationsnummer nr.
+ * Weitere Stationen mit gleicher Nummer folgen ueber catalog.same.
+ *
+ * Rueckgabewert ist
+ *    Index der (ersten) Station in station_list, wenn sie enthalten ist
+ *    -1, wenn die Station nicht in der Stationsliste enthalten ist
+ */
+int
+find_station(const struct archive* archive, int nr)
+{
+	const struct station_catalog* catalog = &archive->catalog;
+	unsigned int h;
+
+	for (h = (unsigned int)nr * 2654435761u; ; h++) {
+		h &= catalog->size - 1;
+
+		if (catalog->slot[h] < 0)
+			return -1;
+		if (archive->station_list[catalog->slot[h]].nr == nr)
+			return catalog->slot[h];
+	}
+}
+
+/*
+ * Suchen aller Stationen, die hoechstens den Winkel radius (Rad) von der 
+ * Position X entfernt liegen koennen. Es werden alle Stationen aus den 
+ * Indexzellen geliefert, die den Kreis um X schneiden (die genaue 
+ * Abstandspruefung erfolgt im IDW-Kern). Die Stationsindizes
+ * werden aufsteigend sortiert in list gespeichert.
+ *
+ * Rueckgabewert ist die Anzahl der gefundenen Stationen
+ */
+int
+find_stations(const struct station_index* index, double X[], double radius,
+    int* list)
+{
+	int    i, j, k, n, la_first, la_last, lo_first, lo_last, cell;
+	double lo, la, dlo;
+
+	/* 
+	 * Rundungsreserve, damit keine Station am Rand des Kreises 
+	 * verloren geht
+	 */
+	radius += 1e-9;
+
+	lo = atan2(X[1], X[0]);
+	la = asin(X[2] > 1.0 ? 1.0 : (X[2] < -1.0 ? -1.0 : X[2]));
+
+	la_first = (int)floor((la - radius + M_PI / 2) / index->la_cell);
+	la_last = (int)floor((la + radius + M_PI / 2) / index->la_cell);
+	if (la_first < 0)
+		la_first = 0;
+	if (la_last > index->la_max - 1)
+		la_last = index->la_max - 1;
+
+	/* 
+	 * Wenn der Kreis einen Pol enthaelt, werden alle Laengengrade
+	 * durchsucht, sonst nur die maximale Laengendifferenz des Kreises
+	 */
+	if ((radius >= M_PI / 2 - fabs(la)) || 
+	    (sin(radius) >= cos(la))) {
+		lo_first = 0;
+		lo_last = index->lo_max - 1;
+	}
+	else {
+		dlo = asin(sin(radius) / cos(la));
+		lo_first = (int)floor((lo - dlo + M_PI) / index->lo_cell);
+		lo_last = (int)floor((lo + dlo + M_PI) / index->lo_cell);
+		if (lo_last - lo_first >= index->lo_max - 1) {
+			lo_first = 0;
+			lo_last = index->lo_max - 1;
 		}
 	}
 
-        /* Wenn Rueckwaertstrajektorie */
-	else { 
-		while (!time_equal(time_dummy, winddata->time)) {
-			time_step_backward(&time_dummy);
-			state->data_diff += 1;
-		}
-	}
+	n = 0;
+	for (i = la_first; i <= la_last; i++) {
+		for (j = lo_first; j <= lo_last; j++) {
+
+			/* Laengengrad ueber -180/180 hinaus */
+			cell = i * index->lo_max + 
+			    ((j % index->lo_max) + index->lo_max) % 
+			    index->lo_max;
+
+			for (k = index->first[cell]; 
+			     k < index->first[cell + 1]; k++) {
+				list[n++] = index->station[k];
+			}
+		}
+	}
+
+	/* 
+	 * Sortieren, damit die Summation in der Reihenfolge der 
+	 * Stationsliste erfolgt
+	 */
+	qsort(list, n, sizeof(int), compare_int);
+
+	return n;
+}
+
+/*
+ * Verwerfen der Stunden-Windfelder eines eingelesenen Tages (Tagesindex d
+ * in archive->timeline)
+ */
+void
+free_day(struct archive* archive, int d)
+{
+	struct timeline* timeline = &archive->timeline;
+	int i;
+
+	for (i = d * 24; i < (d + 1) * 24; i++) {
+		if (timeline->mapped[i] == 0)
+			free(timeline->field[i].report);
+		timeline->field[i].report = NULL;
+		timeline->field[i].n = 0;
+		timeline->mapped[i] = 0;
+	}
+
+	/* Nachschlagetabellen des Tages zuruecksetzen */
+	init_timeline(timeline, d * 24, (d + 1) * 24);
+
+	archive->cache.loaded[d] = 0;
+	archive->cache.loaded_max -= 1;
+}
+
+/* Freigeben eines Gitter-Windfelds */
+void
+free_grid(struct grid* grid)
+{
+	if (grid->mapped) {
+#ifdef USE_MMAP
+		munmap(grid->data, grid->size);
+#endif
+	}
+	else {
+		free(grid->data);
+	}
+	free(grid);
+}
+
+/* Freigeben einer Delaunay-Triangulation */
+void
+free_mesh(struct mesh* mesh)
+{
+	free(mesh->station);
+	free(mesh->vertex);
+	free(mesh->X);
+	free(mesh->triangle);
+	free(mesh);
+}
+
+/*
+ * Generieren des Dateinamens eines Gitter-Windfelds in GRIDCACHE aus 
+ * seinem Schluessel
+ *
+ * Rueckgabewert ist die Laenge des generierten Dateinamens
+ */
+int
+generate_grid_filename(unsigned long long key, char* filename, size_t size)
+{
+	return snprintf(filename, size, "%s%016llx.grd", 
+	    get_string(GRIDCACHE), key);
+}
+
+/* 
+ * Generieren des Namens der Tagesdatei (bYYMMDD.new) im Verzeichnis METEO 
+ * fuer einen Tag (Tage seit dem 01.01.1970)
+ *
+ * Rueckgabewert ist die Laenge des generierten Dateinamens
+ */
+int
+generate_input_filename(int day, char* filename, size_t size)
+{
+	struct date time;
+
+	hours_to_date(day * 24, &time);
+
+        /* 1999 -> 99 */
+	return snprintf(filename, size, "%sb%02i%02i%02i.new", 
+	    get_string(METEO), time.year - (time.year / 100 * 100), 
+	    time.month, time.day);
+}
+
+/* 
+ * Generieren eines Ausgabedateinamens aus den gesetzten Programmparametern 
+ *
+ * Rueckgabewert ist der generierte Dateinamen
+ */
+int
+generate_output_filename(const struct state* state, char* filename, 
+    size_t size)
+{
+	char position[MAXLINE];
+	char sweep[MAXLINE];
+
+	/* Im Batchbetrieb gehoert die Startposition zum Namen */
+	position[0] = '\0';
+	if (strlen(get_string(JOBS)) > 0) {
+		snprintf(position, MAXLINE, "_LO%.6f_LA%.6f", state->job.lo,
+		    state->job.la);
+	}
+
+	/* Bei einer Parameterstudie gehoeren die Parameter zum Namen */
+	sweep[0] = '\0';
+	if (strlen(get_string(SWEEP)) > 0) {
+		snprintf(sweep, MAXLINE, "_SPEED%g_ROT%g_MAXR%i_MINR%i",
+		    state->job.speed, state->job.rot, state->job.maxr,
+		    state->job.minr);
+	}
+
+	/* Wenn Rueckwaertstrajektorie */
+	if (state->job.trace < 0) { 
+		return snprintf(filename, size, 
+		    "%sB%04i%02i%02i_%02i%s%s.trj",
+		    get_string(OUTPUT), state->job.time.year, 
+		    state->job.time.month, state->job.time.day, 
+		    state->job.time.hour, position, sweep);
+	}
+			
+	/* Wenn Vorwaertstrajektorie */
+	else { 
+		return snprintf(filename, size, 
+		    "%sF%04i%02i%02i_%02i%s%s.trj",
+		    get_string(OUTPUT), state->job.time.year, 
+		    state->job.time.month, state->job.time.day, 
+		    state->job.time.hour, position, sweep);
+	}
+}
+
+/*
+ * Verschieben des Winddatenfeldes wind_data um data_diff bis zum
+ * naechstn gueltigen Datenblock
+ *
+ * Rueckgabewert ist der Index des neu eingelesenen Daten-Windfeldes
+ */
+int
+get_next_wind_data(struct state* state, int data)
+{
+	const struct timeline* timeline = &state->archive->timeline;
+	int   next;
+
+        /* Wenn Vorwaertstrajektorie */
+	if (state->job.trace > 0) { 
+		next = find_field(state, data + 1, 1);
+	}
+
+        /* Wenn Rueckwaertstrajektorie */
+	else { 
+		next = find_field(state, data - 1, -1);
+	}
+
+	if (next < 0) {
+		printf("get_next_wind_data: end of list!\n");
+		exit(1);
+	}
+
+	state->data_diff = abs(next - data);
+
+	if (state->job.trace > 0) {
+		state->wind_data[0] = state->wind_data[1];
+		state->wind_data[1] = &timeline->field[next];
+	}
+	else {
+		state->wind_data[1] = state->wind_data[0];
+		state->wind_data[0] = &timeline->field[next];
+	}
+
+	/* Tage hinter den Daten-Windfeldern freigeben */
+	hold_days(state, (state->wind_data[0] - timeline->field) / 24,
+	    (state->wind_data[1] - timeline->field) / 24);
+	
+	return next;
+}
+
+/*
+ * Berechnen des Schluessels eines Gitter-Windfelds als FNV-1a-Hashwert 
+ * ueber die Gittergeometrie, die Interpolationsparameter (MAXR, MINR, 
+ * STDDEVIATION, WEIGHTMODE, KNEAREST, KMAXR) und das Stunden-Windfeld 
+ * wind_current[0] (Position und korrigierter Windvektor jeder Station mit
+ * Daten). Gleiche Winddaten und Parameter ergeben so auch in spaeteren 
+ * Programmlaeufen denselben Schluessel, gleich ob aus METEO oder ARCHIVE 
+ * gelesen wurde.
+ *
+ * Rueckgabewert ist der Schluessel
+ */
+unsigned long long
+grid_key(const struct state* state)
+{
+	const struct grid_header* shape = &state->grid_shape;
+	const struct station*     station_list = state->archive->station_list;
+	const struct wind_field*  current = &state->wind_current[0];
+	unsigned long long        key = 14695981039346656037ULL;
+	double                    stddev = get_float(STDDEVIATION);
+	int                       mode = get_int(WEIGHTMODE);
+	int                       nearest = get_int(KNEAREST);
+	int                       i;
+
+	key = hash_bytes(key, &shape->lo_max, sizeof(int));
+	key = hash_bytes(key, &shape->la_max, sizeof(int));
+	key = hash_bytes(key, &shape->lo_first, sizeof(double));
+	key = hash_bytes(key, &shape->la_first, sizeof(double));
+	key = hash_bytes(key, &shape->step, sizeof(double));
+	key = hash_bytes(key, &state->cos_max_r, sizeof(double));
+	key = hash_bytes(key, &state->cos_min_r, sizeof(double));
+	key = hash_bytes(key, &stddev, sizeof(double));
+	key = hash_bytes(key, &mode, sizeof(int));
+	key = hash_bytes(key, &nearest, sizeof(int));
+
+	for (i = 0; i < current->n; i++) {
+		key = hash_bytes(key, station_list[current->wind[i].s].X, 
+		    3 * sizeof(double));
+		key = hash_bytes(key, &current->wind[i].u, sizeof(double));
+		key = hash_bytes(key, &current->wind[i].v, sizeof(double));
+	}
+
+	return key;
+}
+
+/*
+ * Einteilen der Auftraege in Gruppen fuer den Gleichschritt (LOCKSTEP). 
+ * Die Auftraege werden dazu sortiert (siehe compare_jobs()); eine Gruppe 
+ * umfasst bis zu LOCKSTEP aufeinanderfolgende Auftraege mit gleicher 
+ * Richtung, SPEED und ROT, deren Startzeit im Berechnungszeitraum der 
+ * bisherigen Mitglieder liegt, so dass die gemeinsamen Stunden-Windfelder
+ * lueckenlos genutzt werden.
+ *
+ * Rueckgabewert ist der Index des ersten Auftrags jeder Gruppe in job 
+ * (group_max + 1 Eintraege, der letzte ist job_max)
+ */
+int*
+group_jobs(struct job* job, int job_max, int* group_max)
+{
+	int* group = malloc((job_max + 1) * sizeof(int));
+	int  i, start, end = 0;
+
+	qsort(job, job_max, sizeof(struct job), compare_jobs);
+
+	*group_max = 0;
+
+	for (i = 0; i < job_max; i++) {
+		start = date_to_hours(&job[i].time);
+
+		if ((i == 0) || 
+		    (i - group[*group_max - 1] >= get_int(LOCKSTEP)) ||
+		    ((job[i].trace > 0) != (job[i - 1].trace > 0)) ||
+		    (job[i].speed != job[i - 1].speed) ||
+		    (job[i].rot != job[i - 1].rot) ||
+		    ((job[i].trace > 0) ? (start > end) : (start < end))) {
+			group[*group_max] = i;
+			*group_max += 1;
+			end = start;
+		}
+
+		/* Ende des Berechnungszeitraums der Gruppe */
+		if ((job[i].trace > 0) ? (start + job[i].trace > end) :
+		    (start + job[i].trace < end)) {
+			end = start + job[i].trace;
+		}
+	}
+	group[*group_max] = job_max;
+
+	return group;
+}
+
+/*
+ * Fortschreiben eines FNV-1a-Hashwerts (64 Bit) um size Bytes ab data
+ *
+ * Rueckgabewert ist der neue Hashwert
+ */
+unsigned long long
+hash_bytes(unsigned long long key, const void* data, size_t size)
+{
+	const unsigned char* byte = data;
+	size_t               i;
+
+	for (i = 0; i < size; i++) {
+		key ^= byte[i];
+		key *= 1099511628211ULL;
+	}
+
+	return key;
+}
+
+/*
+ * Festlegen der von einer Trajektorie gehaltenen Tage der Zeitfolge auf 
+ * die Tagesindizes first bis last (first > last: keine). Neu hinzukommende
+ * Tage werden angefordert, nicht mehr benoetigte Tage freigegeben. Ohne 
+ * tageweises Nachladen (WINDOW = 0 ohne SERIES) geschieht nichts.
+ */
+void
+hold_days(struct state* state, int first, int last)
+{
+	int d, end, res;
+
+	if (state->archive->cache.ref == NULL)
+		return;
+
+	/* 
+	 * Erst anfordern, dann freigeben, damit ein weiterhin benoetigter 
+	 * Tag nicht zwischenzeitlich verworfen werden kann
+	 */
+	for (d = first; d <= last; d++) {
+		if ((d < state->day_first) || (d > state->day_last))
+			acquire_day(state->archive, d);
+	}
+
+	for (d = state->day_first; d <= state->day_last; d++) {
+		if ((d < first) || (d > last))
+			release_day(state->archive, d);
+	}
+
+	state->day_first = first;
+	state->day_last = last;
+
+	if (first > last)
+		return;
+
+	/* 
+	 * Naechsten Tag in Berechnungsrichtung vorausladen lassen, wenn er 
+	 * noch im Berechnungszeitraum der Trajektorie (erweitert um RES wie
+	 * in collect_days()) liegt
+	 */
+	res = (get_int(RES) == 0) ? RESMAX : get_int(RES);
+	end = state->time - state->archive->timeline.first + 
+	    state->job.trace;
+
+	if ((state->job.trace > 0) && ((last + 1) * 24 <= end + res)) {
+		prefetch_day(state->archive, last + 1);
+	}
+	if ((state->job.trace < 0) && (first * 24 - 1 >= end - res)) {
+		prefetch_day(state->archive, first - 1);
+	}
+}
+
+/*
+ * Umrechnen der Anzahl der Stunden seit dem 01.01.1970 00 Uhr in eine 
+ * Zeitangabe (gregorianischer Kalender, Umkehrung von date_to_hours())
+ */
+void
+hours_to_date(int hours, struct date* time)
+{
+	int z, era, doe, yoe, doy, mp;
+
+	z = hour_to_day(hours);
+	time->hour = hours - z * 24;
+
+	z += 719468;
+	era = (z >= 0 ? z : z - 146096) / 146097;
+	doe = z - era * 146097;                               /* [0, 146096] */
+	yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	doy = doe - (365 * yoe + yoe / 4 - yoe / 100);          /* [0, 365] */
+	mp = (5 * doy + 2) / 153;                               /* [0, 11] */
+
+	time->day = doy - (153 * mp + 2) / 5 + 1;
+	time->month = mp < 10 ? mp + 3 : mp - 9;
+	time->year = yoe + era * 400 + (time->month <= 2);
+}
+
+/*
+ * IDW-Kern mit Ausreisserfilter (STDDEVIATION > 0): Stationen, deren 
+ * gewichteter Wind in u oder v um mehr als stddev Standardabweichungen vom
+ * Mittelwert abweicht, werden nicht beruecksichtigt. Die Summation erfolgt
+ * in der Reihenfolge der Stationsliste.
+ */
+void
+idw_kernel_filtered(struct kernel* kernel, const double X[], 
+    double cos_min_r, double cos_max_r, double stddev, struct idw_sum* sum)
+{
+	int    k;
+	double val;
+	double amount_wind1, amount_wind2;
+	double u_average_wind1, v_average_wind1;
+	double u_average_wind2, v_average_wind2;
+	double u_stddev_wind1, v_stddev_wind1;
+	double u_stddev_wind2, v_stddev_wind2;
+
+	amount_wind1 = amount_wind2 = 0;
+	u_average_wind1 = v_average_wind1 = 0;
+	u_average_wind2 = v_average_wind2 = 0;
+
+	/* 
+	 * Berechnen der Wichtungsfaktoren der Stationen in Reichweite und 
+	 * aufsummieren der gewichteten Werte
+	 *
+	 * >> Summe = sum(xi) <<
+	 *
+	 */
+	for (k = 0; k < kernel->n; k++) {
+
+		val = kernel->x[k] * X[0] + kernel->y[k] * X[1];
+		val = val + kernel->z[k] * X[2];
+
+		/* Wenn Station naeher als min_r */
+		if (val > cos_min_r) {
+			val = cos_min_r;
+		}
+
+		kernel->w[k] = 0;
+		kernel->p1[k] = kernel->p2[k] = 0;
+
+		/* Wenn Station innerhalb von max_r */
+		if (val > cos_max_r) {
+
+	                /* Wichtung mit 1 / r^2 */
+			kernel->w[k] = idw_weight(val, kernel->mode); 
+
+			if (kernel->m1[k] != 0) {
+				kernel->p1[k] = 1;
+				u_average_wind1 += kernel->u1[k] * kernel->w[k];
+				v_average_wind1 += kernel->v1[k] * kernel->w[k];
+				amount_wind1 += 1;
+			}
+			if (kernel->m2[k] != 0) {
+				kernel->p2[k] = 1;
+				u_average_wind2 += kernel->u2[k] * kernel->w[k];
+				v_average_wind2 += kernel->v2[k] * kernel->w[k];
+				amount_wind2 += 1;
+			}
+		}
+	}
+
+	/* Mittelwerte bilden
+	 *
+	 * >> Mittelwert = Summe / Anzahl <<
+	 *
+	 */
+	average_sum(amount_wind1, &u_average_wind1, &v_average_wind1);
+	average_sum(amount_wind2, &u_average_wind2, &v_average_wind2);
+
+	/* Werte zuruecksetzen */
+	u_stddev_wind1 = v_stddev_wind1 = 0;
+	u_stddev_wind2 = v_stddev_wind2 = 0;
+	amount_wind1 = amount_wind2 = 0;
+
+	/*
+	 * Errechnen der Summe der Abweichungsquadrate
+	 *
+	 * >> QSumme = sum((xi - Mittelwert) *(xi - Mittelwert)) <<
+	 *
+	 */
+	for (k = 0; k < kernel->n; k++) {
+		if (kernel->p1[k] != 0) {
+			u_stddev_wind1 += 
+			    (kernel->u1[k] * kernel->w[k] - u_average_wind1) *
+			    (kernel->u1[k] * kernel->w[k] - u_average_wind1);
+			v_stddev_wind1 += 
+			    (kernel->v1[k] * kernel->w[k] - v_average_wind1) *
+			    (kernel->v1[k] * kernel->w[k] - v_average_wind1);
+			amount_wind1 += 1;
+		}
+		if (kernel->p2[k] != 0) {
+			u_stddev_wind2 += 
+			    (kernel->u2[k] * kernel->w[k] - u_average_wind2) *
+			    (kernel->u2[k] * kernel->w[k] - u_average_wind2);
+			v_stddev_wind2 += 
+			    (kernel->v2[k] * kernel->w[k] - v_average_wind2) *
+			    (kernel->v2[k] * kernel->w[k] - v_average_wind2);
+			amount_wind2 += 1;
+		}
+	}
+
+	/* 
+	 * Wenn Wetterstation in Reichweite sind, kann Standardab-
+	 * weichung berechnet werden.
+	 *
+	 * >> Standardabweichung = wurzel(QSumme / Anzahl) <<
+	 *
+	 */
+	std_deviation(amount_wind1, &u_stddev_wind1, &v_stddev_wind1);
+	std_deviation(amount_wind2, &u_stddev_wind2, &v_stddev_wind2);
+
+	/* 
+	 * Werte mit zu grosser Abweichung rauswerfen (Z-Transformation)
+	 *
+	 * >> z = abs(xi - Mittelwert) / Standardabweichung <<
+	 *
+	 */
+	for (k = 0; k < kernel->n; k++) {
+		if ((kernel->p1[k] != 0) &&
+		    (((fabs(kernel->u1[k] * kernel->w[k] - u_average_wind1)
+			/ u_stddev_wind1) > stddev) ||
+		     ((fabs(kernel->v1[k] * kernel->w[k] - v_average_wind1)
+			/ v_stddev_wind1) > stddev))) {
+			kernel->p1[k] = 0;
+		}
+		if ((kernel->p2[k] != 0) &&
+		    (((fabs(kernel->u2[k] * kernel->w[k] - u_average_wind2)
+			/ u_stddev_wind2) > stddev) ||
+		     ((fabs(kernel->v2[k] * kernel->w[k] - v_average_wind2)
+			/ v_stddev_wind2) > stddev))) {
+			kernel->p2[k] = 0;
+		}
+	}
+
+	/* Berechnen des gemittelten gewichteten Windes */
+	memset(sum, 0, sizeof(struct idw_sum));
+
+	for (k = 0; k < kernel->n; k++) {
+		if (kernel->p1[k] != 0) {
+			sum->u[0] += kernel->u1[k] * kernel->w[k];
+			sum->v[0] += kernel->v1[k] * kernel->w[k];
+			sum->weight[0] += kernel->w[k];
+		}
+		if (kernel->p2[k] != 0) {
+			sum->u[1] += kernel->u2[k] * kernel->w[k];
+			sum->v[1] += kernel->v2[k] * kernel->w[k];
+			sum->weight[1] += kernel->w[k];
+		}
+	}
+}
+
+/*
+ * IDW-Kern fuer den Gleichschritt (skalare Variante): Berechnen der 
+ * gewichteten Summen beider Stunden-Windfelder fuer alle Spuren einer 
+ * Gruppe ueber die verschraenkten Kandidaten. Jede Spur bildet ihre 
+ * Summen wie idw_kernel_scalar() in LANES Teilsummen (der k-te Kandidat 
+ * in Teilsumme k % LANES) und fasst sie in derselben Reihenfolge 
+ * zusammen, so dass die Ergebnisse bitgleich zu denen der Einzel-
+ * berechnung sind.
+ */
+void
+idw_kernel_lanes_scalar(struct lockstep* group)
+{
+	int     i, j, k, l, q;
+	int     mode = get_int(WEIGHTMODE);
+	int     w_max = group->lane_max;
+	double  val, w, w1, w2;
+	double* acc = group->acc;
+
+	/* Teilsummen acc[(6 * q + s) * lane_max + j] */
+	memset(acc, 0, 6 * LANES * w_max * sizeof(double));
+
+	for (k = 0; k < group->n; k++) {
+		q = 6 * (k % LANES) * w_max;
+
+		for (j = 0; j < w_max; j++) {
+			if (k >= group->lane_n[j])
+				continue;
+
+			i = k * w_max + j;
+
+			/* Kosinus des Abstands von Berechnungspunkt und Station*/
+			val = group->x[i] * group->X[0][j] + 
+			    group->y[i] * group->X[1][j];
+			val = val + group->z[i] * group->X[2][j];
+
+			/* Wenn Station naeher als min_r */
+			if (val > group->cos_min_r[j]) {
+				val = group->cos_min_r[j];
+			}
+
+			/* Wichtung mit 1 / r^2, wenn innerhalb von max_r */
+			w = 0;
+			if (val > group->cos_max_r[j]) {
+				w = idw_weight(val, mode);
+			}
+
+			w1 = w * group->m1[i];
+			w2 = w * group->m2[i];
+
+			acc[q + j] += w1 * group->u1[i];
+			acc[q + w_max + j] += w1 * group->v1[i];
+			acc[q + 2 * w_max + j] += w1;
+			acc[q + 3 * w_max + j] += w2 * group->u2[i];
+			acc[q + 4 * w_max + j] += w2 * group->v2[i];
+			acc[q + 5 * w_max + j] += w2;
+		}
+	}
+
+	/* Zusammenfassen der Teilsummen jeder Spur */
+	for (j = 0; j < group->member_max; j++) {
+		for (l = 0; l < 2; l++) {
+			q = 3 * l * w_max + j;
+			group->sum[j].u[l] = 
+			    (acc[q] + acc[q + 6 * w_max]) + 
+			    (acc[q + 12 * w_max] + acc[q + 18 * w_max]);
+			q += w_max;
+			group->sum[j].v[l] = 
+			    (acc[q] + acc[q + 6 * w_max]) + 
+			    (acc[q + 12 * w_max] + acc[q + 18 * w_max]);
+			q += w_max;
+			group->sum[j].weight[l] = 
+			    (acc[q] + acc[q + 6 * w_max]) + 
+			    (acc[q + 12 * w_max] + acc[q + 18 * w_max]);
+		}
+	}
+}
+
+/*
+ * IDW-Kern (skalare Variante): Berechnen der mit 1 / r^2 gewichteten 
+ * Summen beider Stunden-Windfelder in wind_current in einem Durchlauf ueber
+ * die gepackten Kandidaten. Der Wichtungsfaktor jeder Station wird nur 
+ * einmal berechnet und fuer beide Stunden verwendet.
+ *
+ * Die Summen werden wie in den SIMD-Varianten in LANES Teilsummen gebildet
+ * und in derselben Reihenfolge zusammengefasst, so dass alle Varianten 
+ * bitgleiche Ergebnisse liefern.
+ */
+void
+idw_kernel_scalar(const struct kernel* kernel, const double X[], 
+    double cos_min_r, double cos_max_r, struct idw_sum* sum)
+{
+	int    i, k, l;
+	double val, w, w1, w2;
+	double acc[6][LANES];
+
+	memset(acc, 0, sizeof(acc));
+
+	for (k = 0; k < kernel->n; k += LANES) {
+		for (l = 0; l < LANES; l++) {
+			i = k + l;
+
+			/* Kosinus des Abstands von Berechnungspunkt und Station*/
+			val = kernel->x[i] * X[0] + kernel->y[i] * X[1];
+			val = val + kernel->z[i] * X[2];
+
+			/* Wenn Station naeher als min_r */
+			if (val > cos_min_r) {
+				val = cos_min_r;
+			}
+
+			/* Wichtung mit 1 / r^2, wenn innerhalb von max_r */
+			w = 0;
+			if (val > cos_max_r) {
+				w = idw_weight(val, kernel->mode);
+			}
+
+			w1 = w * kernel->m1[i];
+			w2 = w * kernel->m2[i];
+
+			acc[0][l] += w1 * kernel->u1[i];
+			acc[1][l] += w1 * kernel->v1[i];
+			acc[2][l] += w1;
+			acc[3][l] += w2 * kernel->u2[i];
+			acc[4][l] += w2 * kernel->v2[i];
+			acc[5][l] += w2;
+		}
+	}
+
+	/* Zusammenfassen der Teilsummen */
+	for (l = 0; l < 2; l++) {
+		sum->u[l] = (acc[3 * l][0] + acc[3 * l][1]) + 
+		    (acc[3 * l][2] + acc[3 * l][3]);
+		sum->v[l] = (acc[3 * l + 1][0] + acc[3 * l + 1][1]) + 
+		    (acc[3 * l + 1][2] + acc[3 * l + 1][3]);
+		sum->weight[l] = (acc[3 * l + 2][0] + acc[3 * l + 2][1]) + 
+		    (acc[3 * l + 2][2] + acc[3 * l + 2][3]);
+	}
+}
+
+#ifdef USE_SIMD
+/*
+ * IDW-Kern (AVX2-Variante, 4 Stationen pro Schritt). Siehe 
+ * idw_kernel_scalar().
+ */
+__attribute__((target("avx2"))) void
+idw_kernel_avx2(const struct kernel* kernel, const double X[],
+    double cos_min_r, double cos_max_r, struct idw_sum* sum)
+{
+	int     k, l;
+	double  val[LANES], acc[6][LANES];
+	__m256d x0, x1, x2, cmin, cmax, d, in, t, w, w1, w2;
+	__m256d su1, sv1, sw1, su2, sv2, sw2;
+	__m256d one, two, c12, c90, c560;
+
+	one = _mm256_set1_pd(1.0);
+	two = _mm256_set1_pd(2.0);
+	c12 = _mm256_set1_pd(C12);
+	c90 = _mm256_set1_pd(C90);
+	c560 = _mm256_set1_pd(C560);
+	x0 = _mm256_set1_pd(X[0]);
+	x1 = _mm256_set1_pd(X[1]);
+	x2 = _mm256_set1_pd(X[2]);
+	cmin = _mm256_set1_pd(cos_min_r);
+	cmax = _mm256_set1_pd(cos_max_r);
+	su1 = sv1 = sw1 = su2 = sv2 = sw2 = _mm256_setzero_pd();
+
+	for (k = 0; k < kernel->n; k += LANES) {
+
+		/* Kosinus des Abstands, begrenzt auf min_r */
+		d = _mm256_add_pd(
+		    _mm256_mul_pd(_mm256_loadu_pd(kernel->x + k), x0),
+		    _mm256_mul_pd(_mm256_loadu_pd(kernel->y + k), x1));
+		d = _mm256_add_pd(d, 
+		    _mm256_mul_pd(_mm256_loadu_pd(kernel->z + k), x2));
+		d = _mm256_min_pd(d, cmin);
+		in = _mm256_cmp_pd(d, cmax, _CMP_GT_OQ);
+
+		if (_mm256_movemask_pd(in) == 0)
+			continue;
+
+		/* Wichtung mit 1 / r^2 (Bogenlaenge: acos skalar) */
+		if (kernel->mode == 0) {
+			_mm256_storeu_pd(val, d);
+			for (l = 0; l < LANES; l++)
+				val[l] = idw_weight(val[l], 0);
+			w = _mm256_loadu_pd(val);
+		}
+		else {
+			/* Sehnenlaenge t = 2 - 2c */
+			t = _mm256_sub_pd(two, _mm256_mul_pd(two, d));
+
+			/* Bogenlaenge als Polynom von t */
+			if (kernel->mode == 2) {
+				w = _mm256_add_pd(c90, _mm256_mul_pd(t, c560));
+				w = _mm256_add_pd(c12, _mm256_mul_pd(t, w));
+				w = _mm256_add_pd(one, _mm256_mul_pd(t, w));
+				t = _mm256_mul_pd(t, w);
+			}
+			w = _mm256_div_pd(one, t);
+		}
+		w = _mm256_and_pd(w, in);
+
+		w1 = _mm256_mul_pd(w, _mm256_loadu_pd(kernel->m1 + k));
+		w2 = _mm256_mul_pd(w, _mm256_loadu_pd(kernel->m2 + k));
+
+		su1 = _mm256_add_pd(su1, 
+		    _mm256_mul_pd(w1, _mm256_loadu_pd(kernel->u1 + k)));
+		sv1 = _mm256_add_pd(sv1, 
+		    _mm256_mul_pd(w1, _mm256_loadu_pd(kernel->v1 + k)));
+		sw1 = _mm256_add_pd(sw1, w1);
+		su2 = _mm256_add_pd(su2, 
+		    _mm256_mul_pd(w2, _mm256_loadu_pd(kernel->u2 + k)));
+		sv2 = _mm256_add_pd(sv2, 
+		    _mm256_mul_pd(w2, _mm256_loadu_pd(kernel->v2 + k)));
+		sw2 = _mm256_add_pd(sw2, w2);
+	}
+
+	_mm256_storeu_pd(acc[0], su1);
+	_mm256_storeu_pd(acc[1], sv1);
+	_mm256_storeu_pd(acc[2], sw1);
+	_mm256_storeu_pd(acc[3], su2);
+	_mm256_storeu_pd(acc[4], sv2);
+	_mm256_storeu_pd(acc[5], sw2);
+
+	/* Zusammenfassen der Teilsummen */
+	for (l = 0; l < 2; l++) {
+		sum->u[l] = (acc[3 * l][0] + acc[3 * l][1]) + 
+		    (acc[3 * l][2] + acc[3 * l][3]);
+		sum->v[l] = (acc[3 * l + 1][0] + acc[3 * l + 1][1]) + 
+		    (acc[3 * l + 1][2] + acc[3 * l + 1][3]);
+		sum->weight[l] = (acc[3 * l + 2][0] + acc[3 * l + 2][1]) + 
+		    (acc[3 * l + 2][2] + acc[3 * l + 2][3]);
+	}
+}
+
+/*
+ * IDW-Kern fuer den Gleichschritt (AVX2-Variante, 4 Spuren pro Schritt).
+ * Siehe idw_kernel_lanes_scalar().
+ */
+__attribute__((target("avx2"))) void
+idw_kernel_lanes_avx2(struct lockstep* group)
+{
+	int     i, j, k, l, q;
+	int     mode = get_int(WEIGHTMODE);
+	double  val[LANES], acc[6][LANES][LANES];
+	__m256d x0, x1, x2, cmin, cmax, d, in, t, w, w1, w2;
+	__m256d s[6][LANES];
+	__m256d one, two, c12, c90, c560;
+	int     m, n;
+
+	one = _mm256_set1_pd(1.0);
+	two = _mm256_set1_pd(2.0);
+	c12 = _mm256_set1_pd(C12);
+	c90 = _mm256_set1_pd(C90);
+	c560 = _mm256_set1_pd(C560);
+
+	for (j = 0; j < group->lane_max; j += LANES) {
+
+		/* Anzahl der Kandidaten der vier Spuren */
+		for (q = n = 0; q < LANES; q++) {
+			if (group->lane_n[j + q] > n)
+				n = group->lane_n[j + q];
+		}
+
+		x0 = _mm256_loadu_pd(group->X[0] + j);
+		x1 = _mm256_loadu_pd(group->X[1] + j);
+		x2 = _mm256_loadu_pd(group->X[2] + j);
+		cmin = _mm256_loadu_pd(group->cos_min_r + j);
+		cmax = _mm256_loadu_pd(group->cos_max_r + j);
+		for (q = 0; q < LANES; q++) {
+			for (l = 0; l < 6; l++)
+				s[l][q] = _mm256_setzero_pd();
+		}
+
+		for (k = 0; k < n; k += LANES) {
+			for (q = 0; q < LANES; q++) {
+				i = (k + q) * group->lane_max + j;
+
+				/* Kosinus des Abstands, begrenzt auf min_r */
+				d = _mm256_add_pd(
+				    _mm256_mul_pd(_mm256_loadu_pd(group->x + i),
+				    x0),
+				    _mm256_mul_pd(_mm256_loadu_pd(group->y + i),
+				    x1));
+				d = _mm256_add_pd(d, _mm256_mul_pd(
+				    _mm256_loadu_pd(group->z + i), x2));
+				d = _mm256_min_pd(d, cmin);
+				in = _mm256_cmp_pd(d, cmax, _CMP_GT_OQ);
+
+				if (_mm256_movemask_pd(in) == 0)
+					continue;
+
+				/* 
+				 * Wichtung wie in idw_kernel_avx2(), acos nur 
+				 * fuer Spuren mit Station innerhalb von max_r
+				 */
+				if (mode == 0) {
+					_mm256_storeu_pd(val, d);
+					m = _mm256_movemask_pd(in);
+					for (l = 0; l < LANES; l++) {
+						val[l] = ((m >> l) & 1) ? 
+						    idw_weight(val[l], 0) : 0;
+					}
+					w = _mm256_loadu_pd(val);
+				}
+				else {
+					t = _mm256_sub_pd(two, 
+					    _mm256_mul_pd(two, d));
+
+					if (mode == 2) {
+						w = _mm256_add_pd(c90, 
+						    _mm256_mul_pd(t, c560));
+						w = _mm256_add_pd(c12, 
+						    _mm256_mul_pd(t, w));
+						w = _mm256_add_pd(one, 
+						    _mm256_mul_pd(t, w));
+						t = _mm256_mul_pd(t, w);
+					}
+					w = _mm256_div_pd(one, t);
+				}
+				w = _mm256_and_pd(w, in);
+
+				w1 = _mm256_mul_pd(w, 
+				    _mm256_loadu_pd(group->m1 + i));
+				w2 = _mm256_mul_pd(w, 
+				    _mm256_loadu_pd(group->m2 + i));
+
+				s[0][q] = _mm256_add_pd(s[0][q], _mm256_mul_pd(
+				    w1, _mm256_loadu_pd(group->u1 + i)));
+				s[1][q] = _mm256_add_pd(s[1][q], _mm256_mul_pd(
+				    w1, _mm256_loadu_pd(group->v1 + i)));
+				s[2][q] = _mm256_add_pd(s[2][q], w1);
+				s[3][q] = _mm256_add_pd(s[3][q], _mm256_mul_pd(
+				    w2, _mm256_loadu_pd(group->u2 + i)));
+				s[4][q] = _mm256_add_pd(s[4][q], _mm256_mul_pd(
+				    w2, _mm256_loadu_pd(group->v2 + i)));
+				s[5][q] = _mm256_add_pd(s[5][q], w2);
+			}
+		}
+
+		for (q = 0; q < LANES; q++) {
+			for (l = 0; l < 6; l++)
+				_mm256_storeu_pd(acc[l][q], s[l][q]);
+		}
+
+		/* Zusammenfassen der Teilsummen jeder Spur */
+		for (q = 0; (q < LANES) && (j + q < group->member_max); q++) {
+			for (l = 0; l < 2; l++) {
+				group->sum[j + q].u[l] = 
+				    (acc[3 * l][0][q] + acc[3 * l][1][q]) + 
+				    (acc[3 * l][2][q] + acc[3 * l][3][q]);
+				group->sum[j + q].v[l] = 
+				    (acc[3 * l + 1][0][q] + 
+				    acc[3 * l + 1][1][q]) + 
+				    (acc[3 * l + 1][2][q] + 
+				    acc[3 * l + 1][3][q]);
+				group->sum[j + q].weight[l] = 
+				    (acc[3 * l + 2][0][q] + 
+				    acc[3 * l + 2][1][q]) + 
+				    (acc[3 * l + 2][2][q] + 
+				    acc[3 * l + 2][3][q]);
+			}
+		}
+	}
+}
+
+/*
+ * IDW-Kern (SSE2-Variante, 2 x 2 Stationen pro Schritt, damit die 
+ * Teilsummen denen der anderen Varianten entsprechen). Siehe 
+ * idw_kernel_scalar().
+ */
+void
+idw_kernel_sse2(const struct kernel* kernel, const double X[],
+    double cos_min_r, double cos_max_r, struct idw_sum* sum)
+{
+	int     h, k, l;
+	double  val[2], acc[6][LANES];
+	__m128d x0, x1, x2, cmin, cmax, d, in, t, w, w1, w2;
+	__m128d su1[2], sv1[2], sw1[2], su2[2], sv2[2], sw2[2];
+	__m128d one, two, c12, c90, c560;
+
+	one = _mm_set1_pd(1.0);
+	two = _mm_set1_pd(2.0);
+	c12 = _mm_set1_pd(C12);
+	c90 = _mm_set1_pd(C90);
+	c560 = _mm_set1_pd(C560);
+	x0 = _mm_set1_pd(X[0]);
+	x1 = _mm_set1_pd(X[1]);
+	x2 = _mm_set1_pd(X[2]);
+	cmin = _mm_set1_pd(cos_min_r);
+	cmax = _mm_set1_pd(cos_max_r);
+	for (h = 0; h < 2; h++) {
+		su1[h] = sv1[h] = sw1[h] = _mm_setzero_pd();
+		su2[h] = sv2[h] = sw2[h] = _mm_setzero_pd();
+	}
+
+	for (k = 0; k < kernel->n; k += LANES) {
+		for (h = 0; h < 2; h++) {
+			l = k + 2 * h;
+
+			/* Kosinus des Abstands, begrenzt auf min_r */
+			d = _mm_add_pd(
+			    _mm_mul_pd(_mm_loadu_pd(kernel->x + l), x0),
+			    _mm_mul_pd(_mm_loadu_pd(kernel->y + l), x1));
+			d = _mm_add_pd(d, 
+			    _mm_mul_pd(_mm_loadu_pd(kernel->z + l), x2));
+			d = _mm_min_pd(d, cmin);
+			in = _mm_cmpgt_pd(d, cmax);
+
+			if (_mm_movemask_pd(in) == 0)
+				continue;
+
+			/* Wichtung mit 1 / r^2 (Bogenlaenge: acos skalar) */
+			if (kernel->mode == 0) {
+				_mm_storeu_pd(val, d);
+				val[0] = idw_weight(val[0], 0);
+				val[1] = idw_weight(val[1], 0);
+				w = _mm_loadu_pd(val);
+			}
+			else {
+				/* Sehnenlaenge t = 2 - 2c */
+				t = _mm_sub_pd(two, _mm_mul_pd(two, d));
+
+				/* Bogenlaenge als Polynom von t */
+				if (kernel->mode == 2) {
+					w = _mm_add_pd(c90, _mm_mul_pd(t, c560));
+					w = _mm_add_pd(c12, _mm_mul_pd(t, w));
+					w = _mm_add_pd(one, _mm_mul_pd(t, w));
+					t = _mm_mul_pd(t, w);
+				}
+				w = _mm_div_pd(one, t);
+			}
+			w = _mm_and_pd(w, in);
+
+			w1 = _mm_mul_pd(w, _mm_loadu_pd(kernel->m1 + l));
+			w2 = _mm_mul_pd(w, _mm_loadu_pd(kernel->m2 + l));
+
+			su1[h] = _mm_add_pd(su1[h], 
+			    _mm_mul_pd(w1, _mm_loadu_pd(kernel->u1 + l)));
+			sv1[h] = _mm_add_pd(sv1[h], 
+			    _mm_mul_pd(w1, _mm_loadu_pd(kernel->v1 + l)));
+			sw1[h] = _mm_add_pd(sw1[h], w1);
+			su2[h] = _mm_add_pd(su2[h], 
+			    _mm_mul_pd(w2, _mm_loadu_pd(kernel->u2 + l)));
+			sv2[h] = _mm_add_pd(sv2[h], 
+			    _mm_mul_pd(w2, _mm_loadu_pd(kernel->v2 + l)));
+			sw2[h] = _mm_add_pd(sw2[h], w2);
+		}
+	}
+
+	for (h = 0; h < 2; h++) {
+		_mm_storeu_pd(acc[0] + 2 * h, su1[h]);
+		_mm_storeu_pd(acc[1] + 2 * h, sv1[h]);
+		_mm_storeu_pd(acc[2] + 2 * h, sw1[h]);
+		_mm_storeu_pd(acc[3] + 2 * h, su2[h]);
+		_mm_storeu_pd(acc[4] + 2 * h, sv2[h]);
+		_mm_storeu_pd(acc[5] + 2 * h, sw2[h]);
+	}
+
+	/* Zusammenfassen der Teilsummen */
+	for (l = 0; l < 2; l++) {
+		sum->u[l] = (acc[3 * l][0] + acc[3 * l][1]) + 
+		    (acc[3 * l][2] + acc[3 * l][3]);
+		sum->v[l] = (acc[3 * l + 1][0] + acc[3 * l + 1][1]) + 
+		    (acc[3 * l + 1][2] + acc[3 * l + 1][3]);
+		sum->weight[l] = (acc[3 * l + 2][0] + acc[3 * l + 2][1]) + 
+		    (acc[3 * l + 2][2] + acc[3 * l + 2][3]);
+	}
+}
+#endif
+
+/*
+ * Wichtungsfaktor 1 / r^2 einer Station mit dem Kosinus val des 
+ * Winkelabstands zum Berechnungspunkt. mode waehlt die Bestimmung von r^2
+ * (siehe ABSTANDSWICHTUNG).
+ *
+ * Rueckgabewert ist der Wichtungsfaktor
+ */
+double
+idw_weight(double val, int mode)
+{
+	double t;
+
+	/* Bogenlaenge */
+	if (mode == 0)
+		return 1 / (acos(val) * acos(val));
+
+	/* Sehnenlaenge */
+	t = 2.0 - 2.0 * val;
+
+	/* Bogenlaenge als Polynom der Sehnenlaenge */
+	if (mode == 2)
+		t = t * (1.0 + t * (C12 + t * (C90 + t * C560)));
+
+	return 1 / t;
+}
+
+/*
+ * Einlesen der Tage day[0] bis day[day_max - 1] (Tage seit dem 01.01.1970,
+ * aufsteigend) in die Zeitfolge archive->timeline. Die Tage werden von 
+ * THREADS Threads gleichzeitig in eigene Puffer eingelesen und danach in 
+ * zeitlicher Reihenfolge in die Zeitfolge uebernommen, so dass das 
+ * Ergebnis nicht von der Threadanzahl abhaengt.
+ */
+void
+ingest_days(struct archive* archive, const int* day, int day_max)
+{
+	struct ingest ingest;
+	int           i, thread_max;
+#ifdef USE_PTHREAD
+	pthread_t*    thread;
+#endif
+
+	ingest.archive = archive;
+	ingest.day = day;
+	ingest.day_max = day_max;
+	ingest.next = 0;
+	ingest.buffer = calloc(day_max, sizeof(struct prefetch));
+
+	thread_max = get_int(THREADS);
+
+	/* Wenn Threadanzahl aus Prozessoranzahl bestimmt werden soll */
+	if (thread_max <= 0) {
+		thread_max = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (thread_max > day_max) {
+		thread_max = day_max;
+	}
+
+#ifdef USE_PTHREAD
+	pthread_mutex_init(&ingest.lock, NULL);
+
+	if (thread_max > 1) {
+		thread = calloc(thread_max, sizeof(pthread_t));
+
+		for (i = 0; i < thread_max; i++) {
+			if (pthread_create(&thread[i], NULL, ingest_main,
+			    &ingest) != 0) {
+				printf("Couldn't create thread!\n");
+				exit(1);
+			}
+		}
+
+		for (i = 0; i < thread_max; i++) {
+			pthread_join(thread[i], NULL);
+		}
+
+		free(thread);
+	}
+	else
+#endif
+	ingest_main(&ingest);
+
+#ifdef USE_PTHREAD
+	pthread_mutex_destroy(&ingest.lock);
+#endif
+
+	/* Zeitlich geordnetes Uebernehmen in die Zeitfolge */
+	for (i = 0; i < day_max; i++) {
+		splice_day(archive, day[i] - archive->timeline.first / 24, 
+		    &ingest.buffer[i]);
+		archive->unknown_count += ingest.buffer[i].unknown_count;
+	}
+
+	free(ingest.buffer);
+}
+
+/* 
+ * Hauptfunktion eines Einlese-Threads: Einlesen des jeweils naechsten noch
+ * nicht vergebenen Tages, bis alle Tage vergeben sind
+ */
+void*
+ingest_main(void* arg)
+{
+	struct ingest* ingest = arg;
+	int            i;
+
+	while (1) {
+#ifdef USE_PTHREAD
+		pthread_mutex_lock(&ingest->lock);
+#endif
+		i = ingest->next;
+		ingest->next += 1;
+#ifdef USE_PTHREAD
+		pthread_mutex_unlock(&ingest->lock);
+#endif
+		if (i >= ingest->day_max)
+			break;
+
+		decode_day(ingest->archive, ingest->day[i], 
+		    &ingest->buffer[i]);
+	}
+
+	return NULL;
+}
+
+/*
+ * Einlesen bzw. Einblenden der von allen Auftraegen gemeinsam genutzten 
+ * Winddaten ueber die Windquelle
+ */
+void
+init_archive(struct archive* archive, const struct job* job, int job_max)
+{
+	memset(archive, 0, sizeof(struct archive));
+
+	wind_source->open(archive, job, job_max);
+}
+
+/*
+ * Festlegen der Geometrie der Gitter-Windfelder einer Trajektorie: Das 
+ * Gitter ueberdeckt alle Stationen der Stationsliste mit einem Rand von
+ * MAXR (bzw. KMAXR) in Schritten von GRID Grad. Ausserhalb dieses Gebiets
+ * liegt keine Station in Reichweite. Bei Auswahl der naechsten Stationen
+ * ohne KMAXR begrenzt MAXR nur das Gitter, nicht die Auswahl.
+ */
+void
+init_grid_shape(struct state* state)
+{
+	const struct station* station_list = state->archive->station_list;
+	struct grid_header*   shape = &state->grid_shape;
+	double west, east, south, north, lo, la, margin;
+	int    i;
+
+	memset(shape, 0, sizeof(struct grid_header));
+	strncpy(shape->magic, GRIDMAGIC, sizeof(shape->magic));
+	shape->version = GRIDVER;
+	shape->step = deg2rad(get_float(GRID));
+
+	west = south = M_PI;
+	east = north = -M_PI;
+
+	for (i = 0; i < state->station_max; i++) {
+		lo = atan2(station_list[i].X[1], station_list[i].X[0]);
+		la = asin(station_list[i].X[2]);
+
+		if (lo < west)
+			west = lo;
+		if (lo > east)
+			east = lo;
+		if (la < south)
+			south = la;
+		if (la > north)
+			north = la;
+	}
+
+	/* 
+	 * Rand von MAXR (bei Auswahl der naechsten Stationen KMAXR, wenn
+	 * gesetzt), in Laengenrichtung zu den Polen hin breiter
+	 */
+	margin = state->job.maxr / RE;
+	if ((get_int(KNEAREST) > 0) && (get_int(KMAXR) > 0)) {
+		margin = get_int(KMAXR) / RE;
+	}
+	south = (south - margin < -M_PI / 2) ? -M_PI / 2 : south - margin;
+	north = (north + margin > M_PI / 2) ? M_PI / 2 : north + margin;
+	la = (fabs(south) > fabs(north)) ? fabs(south) : fabs(north);
+
+	if (sin(margin) < cos(la)) {
+		west -= asin(sin(margin) / cos(la));
+		east += asin(sin(margin) / cos(la));
+	}
+	if ((sin(margin) >= cos(la)) || (east - west >= 2 * M_PI)) {
+		west = -M_PI;
+		east = M_PI;
+	}
+
+	shape->lo_first = west;
+	shape->la_first = south;
+	shape->lo_max = (int)ceil((east - west) / shape->step) + 1;
+	shape->la_max = (int)ceil((north - south) / shape->step) + 1;
+}
+
+/*
+ * Initialisieren einer Gruppe fuer den Gleichschritt aus den Auftraegen 
+ * job[0] bis job[job_max - 1] (siehe group_jobs()). clock beginnt mit 
+ * der Startzeit von job[0] und reicht bis zum Ende der Berechnungszeit-
+ * raeume aller Mitglieder. Die Mitglieder geben ihre eigenen Stunden-
+ * Windfelder ab und verweisen auf die von clock.
+ */
+void
+init_lockstep(struct lockstep* group, struct archive* archive, 
+    const struct job* job, int job_max)
+{
+	struct job    span = job[0];
+	struct state* state;
+	int           i, k, end, size;
+
+	memset(group, 0, sizeof(struct lockstep));
+
+	group->member_max = job_max;
+	group->lane_max = (job_max + LANES - 1) / LANES * LANES;
+	group->member = calloc(job_max, sizeof(struct state));
+	group->offset = calloc(job_max, sizeof(int));
+
+	for (i = 0; i < job_max; i++) {
+		state = &group->member[i];
+		init_values(state, archive, &job[i]);
+
+		/* 
+		 * Distanzberechnungsfaktor fuer Berechnungsrichtung anpassen 
+		 * (siehe prepare_calculate())
+		 */
+		if (state->job.trace > 0) { 
+			state->distance_per_step *= -1;
+		}
+		if (state->job.trace == 0) {
+			printf("Error: TRACE = 0!\n");
+			exit (1);
+		}
+
+		for (k = 0; k < 2; k++) {
+			free(state->wind_current[k].wind);
+			free(state->slot[k]);
+			state->wind_current[k].wind = NULL;
+			state->slot[k] = NULL;
+		}
+	}
+
+	/* Berechnungszeitraum der Gruppe */
+	end = group->member[0].time + job[0].trace;
+	for (i = 1; i < job_max; i++) {
+		k = group->member[i].time + job[i].trace;
+		if ((job[0].trace > 0) ? (k > end) : (k < end))
+			end = k;
+	}
+	span.trace = end - group->member[0].time;
+	init_values(&group->clock, archive, &span);
+
+	for (i = 0; i < job_max; i++) {
+		group->offset[i] = abs(group->member[i].time - 
+		    group->clock.time) * get_int(IPERH);
+	}
+
+	/* Verschraenkte Kandidatenfelder (wie in init_values()) */
+	size = (archive->station_max + LANES) * group->lane_max;
+	group->x = calloc(9 * size, sizeof(double));
+	group->y = group->x + size;
+	group->z = group->x + 2 * size;
+	group->u1 = group->x + 3 * size;
+	group->v1 = group->x + 4 * size;
+	group->m1 = group->x + 5 * size;
+	group->u2 = group->x + 6 * size;
+	group->v2 = group->x + 7 * size;
+	group->m2 = group->x + 8 * size;
+
+	/* Spurfelder */
+	group->lane_n = calloc(group->lane_max, sizeof(int));
+	group->X[0] = calloc(7 * group->lane_max, sizeof(double));
+	group->X[1] = group->X[0] + group->lane_max;
+	group->X[2] = group->X[0] + 2 * group->lane_max;
+	group->cos_min_r = group->X[0] + 3 * group->lane_max;
+	group->cos_max_r = group->X[0] + 4 * group->lane_max;
+	group->u = group->X[0] + 5 * group->lane_max;
+	group->v = group->X[0] + 6 * group->lane_max;
+	group->sum = calloc(group->lane_max, sizeof(struct idw_sum));
+	group->acc = calloc(6 * LANES * group->lane_max, sizeof(double));
+
+	for (i = 0; i < group->lane_max; i++) {
+		group->cos_min_r[i] = 1.0;
+		group->cos_max_r[i] = 2.0;
+	}
+}
+
+/*
+ * Aufbauen des Stationskatalogs ueber die Stationsliste. Die Hashtabelle
+ * ist mindestens doppelt so gross wie die Anzahl der Stationen, so dass
+ * eine Suche im Mittel nur wenige Plaetze beruehrt.
+ */
+void
+init_station_catalog(struct archive* archive)
+{
+	struct station_catalog* catalog = &archive->catalog;
+	unsigned int h;
+	int i, j;
+
+	for (catalog->size = 16; catalog->size < 2 * archive->station_max; )
+		catalog->size *= 2;
+
+	catalog->slot = malloc(catalog->size * sizeof(int));
+	catalog->same = malloc((archive->station_max + 1) * sizeof(int));
+
+	for (i = 0; i < catalog->size; i++)
+		catalog->slot[i] = -1;
+
+	/*
+	 * Eintragen der Stationen in umgekehrter Reihenfolge, so dass die
+	 * Kette gleicher Stationsnummern aufsteigend nach Stationsindex
+	 * verlaeuft
+	 */
+	for (i = archive->station_max - 1; i >= 0; i--) {
+		catalog->same[i] = -1;
+
+		if ((j = find_station(archive,
+		    archive->station_list[i].nr)) >= 0) {
+			catalog->same[i] = j;
+		}
+
+		for (h = (unsigned int)archive->station_list[i].nr *
+		    2654435761u; ; h++) {
+			h &= catalog->size - 1;
+
+			if ((catalog->slot[h] < 0) ||
+			    (catalog->slot[h] == j)) {
+				catalog->slot[h] = i;
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Aufbauen des raeumlichen Index ueber die Stationsliste. Die Zellgroesse
+ * entspricht dem Radius des Berechnungsgebiets (mindestens CELLMIN Grad),
+ * so dass eine Suche nur wenige Zellen beruehrt.
+ */
+void
+init_station_index(struct archive* archive)
+{
+	struct station_index* index = &archive->index;
+	int    i, cell, cell_max;
+	int*   cell_of;
+	double cell_size, lo, la;
+
+	cell_size = get_int(MAXR) / RE;
+	if (cell_size < deg2rad(CELLMIN))
+		cell_size = deg2rad(CELLMIN);
+
+	index->lo_max = (int)ceil(2 * M_PI / cell_size);
+	index->la_max = (int)ceil(M_PI / cell_size);
+	index->lo_cell = 2 * M_PI / index->lo_max;
+	index->la_cell = M_PI / index->la_max;
+	cell_max = index->lo_max * index->la_max;
+
+	index->first = calloc(cell_max + 1, sizeof(int));
+	index->station = calloc(archive->station_max + 1, sizeof(int));
+	cell_of = calloc(archive->station_max + 1, sizeof(int));
+
+	/* Zelle jeder Station bestimmen und Stationen pro Zelle zaehlen */
+	for (i = 0; i < archive->station_max; i++) {
+		lo = atan2(archive->station_list[i].X[1], 
+		    archive->station_list[i].X[0]);
+		la = asin(archive->station_list[i].X[2]);
+
+		cell = (int)floor((la + M_PI / 2) / index->la_cell);
+		if (cell > index->la_max - 1)
+			cell = index->la_max - 1;
+		cell *= index->lo_max;
+		cell += ((int)floor((lo + M_PI) / index->lo_cell)) % 
+		    index->lo_max;
+
+		cell_of[i] = cell;
+		index->first[cell + 1] += 1;
+	}
+
+	for (i = 0; i < cell_max; i++)
+		index->first[i + 1] += index->first[i];
+
+	/* 
+	 * Eintragen der Stationen (aufsteigend nach Stationsindex
+	 * innerhalb jeder Zelle)
+	 */
+	for (i = 0; i < archive->station_max; i++) {
+		index->station[index->first[cell_of[i]]++] = i;
+	}
+
+	/* Zellanfaenge wiederherstellen */
+	for (i = cell_max; i > 0; i--)
+		index->first[i] = index->first[i - 1];
+	index->first[0] = 0;
+
+	free(cell_of);
+}
+
+/*
+ * Aufbauen der Nachschlagetabellen prev und next der Zeitfolge, mit denen
+ * das naechste Windfeld mit Daten vor bzw. nach einer Stunde ohne Suche 
+ * gefunden wird. Die Tabellen werden fuer die Stunden from bis to - 1 
+ * aufgebaut und verweisen nur auf Windfelder innerhalb dieses Bereichs 
+ * (tageweises Nachladen), uebrige Eintraege sind -1.
+ */
+void
+init_timeline(struct timeline* timeline, int from, int to)
+{
+	int i, last;
+
+	if (timeline->prev == NULL) {
+		timeline->prev = malloc((2 * timeline->hour_max + 1) * 
+		    sizeof(int));
+		timeline->next = timeline->prev + timeline->hour_max;
+
+		for (i = 0; i < 2 * timeline->hour_max; i++)
+			timeline->prev[i] = -1;
+	}
+
+	for (i = from, last = -1; i < to; i++) {
+		if (timeline->field[i].report != NULL)
+			last = i;
+		timeline->prev[i] = last;
+	}
+
+	for (i = to - 1, last = -1; i >= from; i--) {
+		if (timeline->field[i].report != NULL)
+			last = i;
+		timeline->next[i] = last;
+	}
+}
+
+/* 
+ * Initialisieren der Datenstruktur zum Abbilden des programminternen 
+ * Berechnungsstatus
+ */
+void
+init_values(struct state* state, struct archive* archive,
+    const struct job* job)
+{
+	int    i, k;
+	double wind_direction;
+
+	memset(state, 0, sizeof(struct state));
+
+	state->job = *job;
+	state->archive = archive;
+	state->day_first = -1;
+	state->day_last = -2;
+
+	state->distance_per_step = 3.6 / (get_int(IPERH) * RE);
+	state->cos_max_r = cos(job->maxr / RE);
+	state->cos_min_r = cos(job->minr / RE);
+
+	/* 
+	 * Bei Auswahl der naechsten Stationen begrenzt nur KMAXR den 
+	 * Abstand (-1: keine Grenze)
+	 */
+	if (get_int(KNEAREST) > 0) {
+		state->cos_max_r = (get_int(KMAXR) > 0) ? 
+		    cos(get_int(KMAXR) / RE) : -1.0;
+		state->nearest_max = get_int(KNEAREST);
+		state->nearest = calloc(4 * state->nearest_max, sizeof(int));
+		state->nearest_cos = calloc(state->nearest_max, 
+		    sizeof(double));
+	}
+	state->station_max = archive->station_max;
+	state->point_max = (int)((double)get_int(IPERH) / 
+	    (double)get_int(IPERPOINT) *
+	    (double)abs(job->trace));
+	state->point = 0;
+
+	state->lo = calloc(state->point_max + 1, sizeof(double));
+	state->la = calloc(state->point_max + 1, sizeof(double));
+
+	for (i = 0; i <= 360; i++) {
+		wind_direction = i;
+		wind_direction += job->rot;
+		wind_direction = deg2rad(wind_direction);
+		state->dir_sin[i] = sin(wind_direction);
+		state->dir_cos[i] = cos(wind_direction);
+	}
+
+	for (i = 0; i < 2; i++) {
+		state->wind_current[i].n = 0;
+		state->wind_current[i].wind = calloc(state->station_max + 1,
+		    sizeof(struct wind));
+		state->slot[i] = malloc((state->station_max + 1) * 
+		    sizeof(int));
+		for (k = 0; k < state->station_max; k++)
+			state->slot[i][k] = -1;
+	}
+	state->candidate = calloc(state->station_max + 1, sizeof(int));
+	state->candidate_max = -1;
+	state->cos_margin = cos(MARGIN / RE);
+
+	/* Gepackte Kandidatenfelder (maximal alle Stationen + Fuellung) */
+	k = state->station_max + LANES;
+	state->kernel.mode = get_int(WEIGHTMODE);
+	state->kernel.rebuild = state->kernel.hour = -1;
+	state->kernel.x = calloc(9 * k, sizeof(double));
+	state->kernel.y = state->kernel.x + k;
+	state->kernel.z = state->kernel.x + 2 * k;
+	state->kernel.u1 = state->kernel.x + 3 * k;
+	state->kernel.v1 = state->kernel.x + 4 * k;
+	state->kernel.m1 = state->kernel.x + 5 * k;
+	state->kernel.u2 = state->kernel.x + 6 * k;
+	state->kernel.v2 = state->kernel.x + 7 * k;
+	state->kernel.m2 = state->kernel.x + 8 * k;
+	state->kernel.w = calloc(k, sizeof(double));
+	state->kernel.p1 = calloc(2 * k, sizeof(int));
+	state->kernel.p2 = state->kernel.p1 + k;
+
+	/* Umrechnung von externer Zeitzone in interne Zeitzone (GMT) */
+	state->time = convert_timezone(&job->time);
+
+	state->lo[0] = deg2rad(job->lo);
+	state->la[0] = deg2rad(job->la);
+
+	/* Umrechnen der Startposition auf geographischen Groessenbereich */
+	normalize_coords(state);
+}
+
+/*
+ * Erstellen der ersten beiden Daten-Windfelder fuer die zeitliche
+ * Interpolation waehrend der Trajektorienberechnung
+ *
+ * Rueckgabewert ist der Index des in Berechnungsrichtung zuletzt 
+ * eingelesenen Daten-Windfeldes
+ */
+int
+init_wind_data(struct state* state)
+{
+	const struct timeline* timeline = &state->archive->timeline;
+	int data; /* Index des Daten-Windfeldes zur (vor der) Startzeit */
+	int next; /* Index des naechsten (spaeteren) Daten-Windfeldes */
+	int i;
+
+	/* Stunde des Berechnungsstartzeitpunkts in der Zeitfolge */
+	i = state->time - timeline->first;
+
+	if ((i < 0) || (i >= timeline->hour_max)) {
+		printf("init_wind_data: end of list!\n");
+		exit(1);
+	}
+
+	/* 
+	 * Wenn zur Startzeit keine Daten vorhanden sind, wird das letzte 
+	 * Daten-Windfeld vor der Startzeit verwendet
+	 */
+	data = find_field(state, i, -1);
+	next = (data >= 0) ? find_field(state, data + 1, 1) : -1;
+
+	if ((data < 0) || (next < 0)) {
+		printf("init_wind_data: end of list!\n");
+		exit(1);
+	}
+
+	/* Nur die Tage der beiden Daten-Windfelder halten */
+	hold_days(state, data / 24, next / 24);
+
+	state->diff = i - data;
+	state->data_diff = next - data;
+
+	state->wind_data[0] = &timeline->field[data];
+	state->wind_data[1] = &timeline->field[next];
+	
+	/* 
+	 * Rueckgabe des in Berechnungsrichtung zuletzt eingelesenen 
+	 * Daten-Windfeldes
+	 */
+	if (state->job.trace > 0)
+		return next;
+	else
+		return data;
+}
+
+/*
+ * Pruefen, ob die Position X im Umkreis des Dreiecks t einer Delaunay-
+ * Triangulation liegt. Auf der Kugel ist das genau dann der Fall, wenn X 
+ * ausserhalb der Ebene durch die drei Ecken liegt.
+ *
+ * Rueckgabewert ist
+ *    1, wenn X im Umkreis liegt
+ *    0, sonst
+ */
+int
+inside_circle(const struct mesh* mesh, int t, const double X[])
+{
+	const double* a = &mesh->X[3 * mesh->triangle[t].v[0]];
+	const double* b = &mesh->X[3 * mesh->triangle[t].v[1]];
+	const double* c = &mesh->X[3 * mesh->triangle[t].v[2]];
+	double        ab[3], ac[3], aX[3];
+	int           i;
+
+	for (i = 0; i < 3; i++) {
+		ab[i] = b[i] - a[i];
+		ac[i] = c[i] - a[i];
+		aX[i] = X[i] - a[i];
+	}
+
+	return (triple_product(ab, ac, aX) > 0);
+}
+
+/*
+ * Fortschreiben der Position state->position des aktuellen Aufpunkts 
+ * (siehe load_position()) bis zur Zeit des Aufpunkts (IPERPOINT / IPERH 
+ * Stunden je Aufpunkt) mit Schrittweitensteuerung (TOL > 0): eingebettetes 
+ * Verfahren von Bogacki-Shampine der Ordnungen 3 und 2. Die Differenz der
+ * beiden Loesungen schaetzt den Fehler des Schritts; ist er groesser als
+ * TOL (km), wird der Schritt verworfen und mit kleinerer Schrittweite 
+ * wiederholt. Die naechste Schrittweite folgt aus dem Verhaeltnis von 
+ * TOL und Fehler (Faktor 0.2 bis 5, hoechstens eine Stunde). Die Schritte 
+ * werden an den vollen Stunden (Weiterschalten der Stunden-Windfelder) und
+ * an der Zeit des Aufpunkts gekuerzt, so dass die Aufpunkte ohne 
+ * Interpolation im gleichen Takt wie bei festen Schritten entstehen. Der 
+ * letzte Windvektor eines angenommenen Schritts ist der erste des 
+ * naechsten, solange keine volle Stunde ueberschritten wird.
+ *
+ * Rueckgabewert ist
+ *    0, wenn der Aufpunkt erreicht wurde
+ *    1, wenn kein Windvektor berechnet werden konnte (die Position 
+ *       bleibt beim letzten angenommenen Schritt)
+ */
+int
+integrate_adaptive(struct state* state)
+{
+	/* Zwischenzeiten c, Gewichte b (3. Ordnung) und e (Fehler) */
+	static const double c[4] = { 0, 0.5, 0.75, 1 };
+	static const double b[3] = { 2.0 / 9, 1.0 / 3, 4.0 / 9 };
+	static const double e[4] = { -5.0 / 72, 1.0 / 12, 1.0 / 9, -0.125 };
+	double* y = state->position;
+	double  rate = (double)get_int(IPERH);
+	double  t = (double)((state->point - 1) * get_int(IPERPOINT)) / 
+	    get_int(IPERH);
+	double  end = (double)(state->point * get_int(IPERPOINT)) / 
+	    get_int(IPERH);
+	double  k[4][3] = { { 0 } };
+	double  stage[3], next[3], err[3];
+	double  h, limit, hour_diff, scale, error, factor;
+	int     i, s, fresh = 0;
+
+	if (state->step_size == 0)
+		state->step_size = 1.0 / rate;
+
+	while (t < end) {
+
+		/* Wenn die naechste volle Zeitstunde erreicht ist */
+		if (t >= state->advance_count) {
+			wind_source->advance(state);
+			state->advance_count += 1;
+			fresh = 0;
+		}
+		hour_diff = t - (state->advance_count - 1);
+
+		/* Kuerzen an der vollen Stunde bzw. am Aufpunkt */
+		limit = (end < state->advance_count) ? end : 
+		    state->advance_count;
+		h = (state->step_size < limit - t) ? state->step_size : 
+		    limit - t;
+
+		/* Stufen 1 bis 3 (Versatz je Stunde) */
+		for (s = (fresh ? 1 : 0); s < 3; s++) {
+			for (i = 0; i < 3; i++)
+				stage[i] = y[i] + c[s] * h * k[(s + 2) % 3][i];
+
+			if (calculate_step(state, hour_diff + c[s] * h, stage,
+			    k[s]) == 1)
+				return 1;
+
+			for (i = 0; i < 3; i++)
+				k[s][i] *= rate;
+		}
+
+		/* Loesung 3. Ordnung und Stufe 4 an deren Endpunkt */
+		for (i = 0; i < 3; i++) {
+			next[i] = y[i] + h * (b[0] * k[0][i] + b[1] * k[1][i] +
+			    b[2] * k[2][i]);
+		}
+
+		if (calculate_step(state, hour_diff + h, next, k[3]) == 1)
+			return 1;
+
+		for (i = 0; i < 3; i++)
+			k[3][i] *= rate;
+
+		/* Fehlerschaetzung in km (Laengenanteil mit cos la) */
+		for (i = 0; i < 3; i++) {
+			err[i] = 0;
+			for (s = 0; s < 4; s++)
+				err[i] += h * e[s] * k[s][i];
+		}
+		scale = (get_int(VECTOR) == 0) ? cos(y[1]) : 1;
+		error = RE * sqrt(err[0] * scale * err[0] * scale + 
+		    err[1] * err[1] + err[2] * err[2]);
+
+		factor = (error > 0) ? 0.9 * cbrt(get_float(TOL) / error) : 5;
+		factor = (factor < 0.2) ? 0.2 : ((factor > 5) ? 5 : factor);
+
+		/* Schritt verwerfen */
+		if ((error > get_float(TOL)) && (h > STEPMIN)) {
+			state->reject_count += 1;
+			state->step_size = (h * factor > STEPMIN) ? 
+			    h * factor : STEPMIN;
+			fresh = 1;
+			continue;
+		}
+
+		/* Schritt annehmen */
+		state->step_count += 1;
+		t = (h == limit - t) ? limit : t + h;
+		for (i = 0; i < 3; i++) {
+			y[i] = next[i];
+			k[0][i] = k[3][i];
+		}
+		if (get_int(VECTOR) != 0)
+			normalize_vector(y);
+		fresh = 1;
+
+		/* 
+		 * Ein gekuerzter Schritt verkleinert die Schrittweite nur, 
+		 * wenn der Fehler es verlangt
+		 */
+		if ((h == state->step_size) || (factor < 1)) {
+			state->step_size = h * factor;
+		}
+		if (state->step_size > 1)
+			state->step_size = 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Ein Iterationsschritt der Position state->position des aktuellen 
+ * Aufpunkts (siehe load_position()) zum Stundenanteil hour_diff mit dem
+ * Euler-Verfahren (INTEGRATOR 0, nur mit VECTOR), dem Verfahren von Heun
+ * (INTEGRATOR 1) bzw. dem klassischen Runge-Kutta-Verfahren (INTEGRATOR
+ * 2). Jede Stufe wertet den Wind an der um den Versatz der vorigen Stufe
+ * verschobenen Position und zur entsprechenden Zwischenzeit aus; die 
+ * Verfahren kommen mit einer Nebendiagonale im Butcher-Schema aus. Der 
+ * Fehler je Stunde faellt mit IPERH^-2 bzw. IPERH^-4 statt IPERH^-1, so 
+ * dass wenige Schritte je Stunde genuegen. Die Zwischenzeiten bleiben in
+ * der laufenden Stunde (hour_diff + 1 / IPERH <= 1).
+ *
+ * Rueckgabewert ist
+ *    0, wenn der Schritt berechnet werden konnte
+ *    1, wenn in einer Stufe kein Windvektor berechnet werden konnte (die 
+ *       Position bleibt dann unveraendert)
+ */
+int
+integrate_step(struct state* state, double hour_diff)
+{
+	/* Stufenanzahl, Zwischenzeiten c und Gewichte b je Verfahren */
+	static const int    stages[3] = { 1, 2, 4 };
+	static const double c[3][4] = {
+		{ 0 }, { 0, 1 }, { 0, 0.5, 0.5, 1 }
+	};
+	static const double b[3][4] = {
+		{ 1 }, { 0.5, 0.5 }, { 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 }
+	};
+	int     method = get_int(INTEGRATOR);
+	double  step = 1.0 / (double)get_int(IPERH);
+	double* y = state->position;
+	double  stage[3], dy[3] = { 0 }, sum[3] = { 0 };
+	int     i, k;
+
+	for (k = 0; k < stages[method]; k++) {
+		for (i = 0; i < 3; i++)
+			stage[i] = y[i] + c[method][k] * dy[i];
+
+		if (calculate_step(state, hour_diff + c[method][k] * step, 
+		    stage, dy) == 1)
+			return 1;
+
+		for (i = 0; i < 3; i++)
+			sum[i] += b[method][k] * dy[i];
+	}
+
+	for (i = 0; i < 3; i++)
+		y[i] += sum[i];
+
+	if (get_int(VECTOR) != 0)
+		normalize_vector(y);
+
+	return 0;
+}
+
+/* Iterieren bis zum naechsten Trajektorienaufpunkt */
+void
+iterate(struct state *state)
+{
+	int    j; 
+        
+        /* 
+	 * Anzahl der durchlaufenen Iterationen seit der letzten vollen 
+	 * Zeitstunde 
+	 */
+	int    iteration; 
+
+	/* Windvektor der momentanen Berechnungsposition */
+	double u, v;
+	
+	/* 
+	 * Zeitverzatz in Stundenanteilen, seit der letzten vollen 
+	 * Zeitstunde 
+	 */
+	double hour_diff;
+
+	/* Momentane Berechnungsposition {kartesisch 3D) */
+	double X[3];
+
+	/* Position im Integrationsraum (bei VECTOR Einheitsvektor) */
+	load_position(state);
+
+	/* Mit Schrittweitensteuerung bis zur Zeit des naechsten Aufpunkts */
+	if (get_float(TOL) > 0.0) {
+		if (integrate_adaptive(state) == 1) {
+			state->point_max = state->point;
+		}
+		store_position(state);
+		return;
+	}
+
+	/* 
+	 * Iterieren bis Iterationszahl fuer naechsten Aufpunkt erreicht 
+	 * ist 
+	 */
+	for (j = 0; j < get_int(IPERPOINT); j++) {
+
+		/* 
+		 * Berechnung der Iterationsanzahl seit letzter vollen 
+		 * Zeitstunde 
+		 */
+		iteration = ((state->point - 1) * get_int(IPERPOINT) + j) % 
+		    get_int(IPERH);
+
+		/* Wenn naechste volle Zeitstunde erreicht ist ... */
+		if (iteration == 0) {
+			
+			/* 
+			 * Weiterschalten der Stunden-Windfelder um eine 
+			 * Zeitstunde
+			 */
+			wind_source->advance(state);
+			
+		}
+
+		/* 
+		 * Berechnen des Stundenanteils seit der letzten vollen 
+		 * Zeitstunde (0 <= hour_diff < 1) 
+		 */
+		hour_diff = (double)iteration / (double)get_int(IPERH);
+
+		/* 
+		 * Verfahren hoeherer Ordnung werten den Wind an Zwischen-
+		 * positionen und -zeiten des Schritts aus; im Raum der 
+		 * Einheitsvektoren wird immer ueber integrate_step() 
+		 * integriert
+		 */
+		if ((get_int(INTEGRATOR) != 0) || (get_int(VECTOR) != 0)) {
+			if (integrate_step(state, hour_diff) == 1) {
+				state->point_max = state->point;
+				j = get_int(IPERPOINT);
+			}
+			continue;
+		}
+
+		/* 
+		 * Umrechnen der momentanen Berechnungskoordinaten 
+		 * (state->lo, state->la) in kartesische 3D-Koordinaten (X) 
+		 */
+		convert_geo_to_cartesian(state->lo[state->point], 
+		    state->la[state->point], X);
+
+		/* 
+		 * Berechnen des interpolierten Windvektors fuer momentane 
+		 * Position (X) 
+		 */
+		if (calculate_wind_vector(hour_diff, &u, &v, X, state) == 1) {
+			/* 
+			 * Wenn kein Windvektor berechnet werden konnte, 
+			 * breche Berechnung ab 
+			 */
+			state->point_max = state->point;
+			j = get_int(IPERPOINT);
+		}
+
+		/* 
+		 * Berechnung des raeumlichen Versatzes fuer diesen 
+		 * Interpolationsschritt 
+		 */
+		state->lo[state->point] = state->lo[state->point] + 
+		    state->distance_per_step * u / 
+		    cos(state->la[state->point]);
+		
+		state->la[state->point] = state->la[state->point] + 
+		    state->distance_per_step * v;
+	}
+
+	if ((get_int(INTEGRATOR) != 0) || (get_int(VECTOR) != 0)) {
+		store_position(state);
+	}
+}
+
+/*
+ * Einlesen eines Tages der Zeitfolge (Tagesindex d in archive->timeline)
+ * bei tageweisem Nachladen. Liegt der Tag bereits in einem Vorauslade-
+ * puffer, wird er von dort uebernommen; wird er gerade vorausgeladen oder
+ * von einer anderen Trajektorie eingelesen, wird darauf gewartet. Sonst 
+ * wird er wie beim Vorausladen ohne cache->lock in einen eigenen Puffer 
+ * eingelesen, so dass die anderen Trajektorien weiterrechnen. Muss 
+ * gewartet oder selbst eingelesen werden, zaehlt das als Wartefall 
+ * (cache->stall_count). Sind bereits WINDOW Tage eingelesen, werden vor 
+ * dem Uebernehmen die am laengsten nicht mehr verwendeten Tage verworfen.
+ * Werden alle eingelesenen Tage noch von Trajektorien gehalten, wird 
+ * WINDOW ueberschritten; WINDOW = 0 (mit SERIES) begrenzt nicht. Der
+ * Aufrufer muss cache->lock halten.
+ */
+void
+load_day(struct archive* archive, int d)
+{
+	struct day_cache* cache = &archive->cache;
+	struct prefetch*  slot;
+	struct prefetch   local;
+	int i, k;
+	int stalled = 0;
+
+	/* Vorausladepuffer des Tages suchen */
+	for (k = 0, slot = NULL; k < 2; k++) {
+		if (cache->slot[k].day == d)
+			slot = &cache->slot[k];
+	}
+
+#ifdef USE_PTHREAD
+	/* 
+	 * Wenn der Tag gerade vorausgeladen oder von einer anderen 
+	 * Trajektorie eingelesen wird, auf das Ende warten 
+	 */
+	while (((slot != NULL) && (slot->state == PREFETCH_LOADING)) ||
+	    (cache->loading[d] != 0)) {
+		stalled = 1;
+		pthread_cond_wait(&cache->done, &cache->lock);
+
+		/* Puffer inzwischen fuer einen anderen Tag verwendet */
+		if ((slot != NULL) && (slot->day != d))
+			slot = NULL;
+	}
+
+	/* Wenn der Tag inzwischen von einer anderen Trajektorie kommt */
+	if (cache->loaded[d] != 0) {
+		cache->stall_count += stalled;
+		return;
+	}
+#endif
+
+	/* Ohne vorausgeladenen Tag muss immer gewartet werden */
+	if (slot == NULL)
+		stalled = 1;
+	cache->stall_count += stalled;
+
+	/* Einlesen ohne Vorausladen in einen eigenen Puffer */
+	if (slot == NULL) {
+		memset(&local, 0, sizeof(struct prefetch));
+		local.day = d;
+		cache->loading[d] = 1;
+#ifdef USE_PTHREAD
+		pthread_mutex_unlock(&cache->lock);
+#endif
+		decode_day(archive, archive->timeline.first / 24 + d, &local);
+#ifdef USE_PTHREAD
+		pthread_mutex_lock(&cache->lock);
+#endif
+		cache->loading[d] = 0;
+	}
+
+	while ((get_int(WINDOW) > 0) && 
+	    (cache->loaded_max >= get_int(WINDOW))) {
+
+		for (i = 0, k = -1; i < cache->day_max; i++) {
+			if ((cache->loaded[i] != 0) && (cache->ref[i] == 0) &&
+			    ((k < 0) || (cache->used[i] < cache->used[k])))
+				k = i;
+		}
+
+		/* Wenn alle eingelesenen Tage gehalten werden */
+		if (k < 0)
+			break;
+
+		free_day(archive, k);
+	}
+
+	/* Uebernehmen des eingelesenen Tages */
+	if (slot == NULL) {
+		splice_day(archive, d, &local);
+
+		/* 
+		 * Unbekannte Stationen nur beim ersten Einlesen des Tages
+		 * zaehlen 
+		 */
+		if (cache->counted[d] == 0) {
+			archive->unknown_count += local.unknown_count;
+		}
+	}
+
+	/* Uebernehmen des vorausgeladenen Tages */
+	else {
+		splice_day(archive, d, slot);
+
+		if (cache->counted[d] == 0) {
+			archive->unknown_count += slot->unknown_count;
+		}
+
+		drop_prefetch(slot);
+		cache->prefetch_count += 1;
+	}
+	cache->counted[d] = 1;
+
+	/* Nachschlagetabellen fuer die Stunden des Tages aufbauen */
+	init_timeline(&archive->timeline, d * 24, (d + 1) * 24);
+
+	cache->loaded[d] = 1;
+	cache->loaded_max += 1;
+	cache->load_count += 1;
+
+	if (cache->loaded_max > cache->loaded_peak) {
+		cache->loaded_peak = cache->loaded_max;
+	}
+
+#ifdef USE_PTHREAD
+	/* Auf diesen Tag wartende Trajektorien wecken */
+	pthread_cond_broadcast(&cache->done);
+#endif
+}
+
+/*
+ * Laden der Position des aktuellen Aufpunkts in state->position zu 
+ * Beginn von iterate(). Im geographischen Raum ist das (lo, la, 0) des 
+ * Aufpunkts. Bei Integration im Raum der Einheitsvektoren (VECTOR) wird 
+ * der Ortsvektor nur am Start aus (lo, la) berechnet und danach ueber 
+ * alle Aufpunkte fortgeschrieben, so dass die Rundung von lo und la die
+ * Integration nicht beeinflusst.
+ */
+void
+load_position(struct state* state)
+{
+	if (get_int(VECTOR) == 0) {
+		state->position[0] = state->lo[state->point];
+		state->position[1] = state->la[state->point];
+		state->position[2] = 0;
+	}
+	else if (state->point == 1) {
+		convert_geo_to_cartesian(state->lo[0], state->la[0], 
+		    state->position);
+	}
+}
+
+/*
+ * Bilineares Interpolieren des Windvektors an der Position X aus einem 
+ * Gitter-Windfeld. Das Ergebnis wird wie beim IDW-Kern als gewichtete 
+ * Summe in sum->u[k], sum->v[k] und sum->weight[k] abgelegt (Gewicht 1,
+ * bzw. 0, wenn nicht alle vier umgebenden Gitterpunkte abgedeckt sind).
+ */
+void
+lookup_grid(const struct grid* grid, const double X[], int k, 
+    struct idw_sum* sum)
+{
+	const struct grid_header* header;
+	double lo, la, x, y;
+	int    i, j, n;
+
+	sum->u[k] = sum->v[k] = sum->weight[k] = 0;
+
+	if (grid == NULL)
+		return;
+
+	header = grid->header;
+	lo = atan2(X[1], X[0]);
+	la = asin(X[2] > 1 ? 1 : (X[2] < -1 ? -1 : X[2]));
+
+	x = (lo - header->lo_first) / header->step;
+	y = (la - header->la_first) / header->step;
+	i = (int)floor(x);
+	j = (int)floor(y);
+
+	/* Ausserhalb des Gitters */
+	if ((i < 0) || (i >= header->lo_max - 1) ||
+	    (j < 0) || (j >= header->la_max - 1))
+		return;
+
+	n = j * header->lo_max + i;
+
+	if (!grid->mask[n] || !grid->mask[n + 1] ||
+	    !grid->mask[n + header->lo_max] || 
+	    !grid->mask[n + header->lo_max + 1])
+		return;
+
+	x -= i;
+	y -= j;
+
+	sum->u[k] = (1 - y) * ((1 - x) * grid->u[n] + x * grid->u[n + 1]) +
+	    y * ((1 - x) * grid->u[n + header->lo_max] + 
+	    x * grid->u[n + header->lo_max + 1]);
+	sum->v[k] = (1 - y) * ((1 - x) * grid->v[n] + x * grid->v[n + 1]) +
+	    y * ((1 - x) * grid->v[n + header->lo_max] + 
+	    x * grid->v[n + header->lo_max + 1]);
+	sum->weight[k] = 1;
+}
+
+/*
+ * Baryzentrisches Interpolieren des Windvektors an der Position X aus 
+ * dem Stunden-Windfeld wind_current[k] ueber dessen Delaunay-
+ * Triangulation. Das Dreieck wird ab dem Dreieck des letzten Schritts 
+ * gesucht (siehe walk_mesh()). Das Ergebnis wird wie beim IDW-Kern als 
+ * gewichtete Summe in sum->u[k], sum->v[k] und sum->weight[k] abgelegt 
+ * (Gewicht 0 ausserhalb des Stationsnetzes, d.h. in Dreiecken mit einem 
+ * Hilfspunkt).
+ */
+void
+lookup_mesh(struct state* state, const double X[], int k, 
+    struct idw_sum* sum)
+{
+	const struct mesh*     mesh = state->mesh[k];
+	const struct triangle* triangle;
+	const struct wind*     wind;
+	double                 weight;
+	int                    i, t;
+
+	sum->u[k] = sum->v[k] = sum->weight[k] = 0;
+
+	if (mesh == NULL)
+		return;
+
+	t = state->triangle[k];
+	if ((t < 0) || (t >= mesh->triangle_max))
+		t = 0;
+
+	t = walk_mesh(mesh, X, t);
+	state->triangle[k] = t;
+	triangle = &mesh->triangle[t];
+
+	/* Ausserhalb des Stationsnetzes */
+	for (i = 0; i < 3; i++) {
+		if (mesh->vertex[triangle->v[i]] < 0)
+			return;
+	}
+
+	/* 
+	 * Baryzentrische Gewichte aus den Spatprodukten gegenueber jeder
+	 * Ecke (Zentralprojektion von X auf die Dreiecksebene)
+	 */
+	for (i = 0; i < 3; i++) {
+		weight = triple_product(
+		    &mesh->X[3 * triangle->v[(i + 1) % 3]], 
+		    &mesh->X[3 * triangle->v[(i + 2) % 3]], X);
+		wind = &state->wind_current[k].wind[
+		    state->slot[k][mesh->vertex[triangle->v[i]]]];
+
+		sum->u[k] += weight * wind->u;
+		sum->v[k] += weight * wind->v;
+		sum->weight[k] += weight;
+	}
+}
+
+/*
+ * Windquelle Stationsmeldungen: Gewichtete Summen beider Stunden-
+ * Windfelder an der Position X aus dem IDW-Kern, den Gitter-Windfeldern
+ * bzw. den Delaunay-Triangulationen
+ */
+void
+lookup_stations(struct state* state, double X[], struct idw_sum* sum)
+{
+	/* 
+	 * Mit Delaunay-Triangulationen werden beide Stunden-Windfelder 
+	 * baryzentrisch im umgebenden Dreieck interpoliert
+	 */
+	if (get_int(DELAUNAY) != 0) {
+		lookup_mesh(state, X, 0, sum);
+		lookup_mesh(state, X, 1, sum);
+	}
+
+	/* 
+	 * Mit Gitter-Windfeldern werden beide Stunden-Windfelder bilinear
+	 * aus ihren Gittern interpoliert
+	 */
+	else if (get_float(GRID) > 0.0) {
+		lookup_grid(state->grid[0], X, 0, sum);
+		lookup_grid(state->grid[1], X, 1, sum);
+	}
+
+	/* 
+	 * Bei Auswahl der naechsten Stationen werden nur die KNEAREST 
+	 * naechsten Stationen jedes Stunden-Windfelds gepackt
+	 */
+	else if (get_int(KNEAREST) > 0) {
+		update_nearest(state, X);
+		pack_nearest(state, X);
+
+		if (get_float(STDDEVIATION) > 0.0) {
+			idw_kernel_filtered(&state->kernel, X, 
+			    state->cos_min_r, state->cos_max_r, 
+			    get_float(STDDEVIATION), sum);
+		}
+		else {
+			idw_kernel(&state->kernel, X, state->cos_min_r, 
+			    state->cos_max_r, sum);
+		}
+	}
+
+	/* 
+	 * Wenn maximale Standardabweichung angegeben ist, werden alle 
+	 * Stationen, die in u oder v eine groessere Abweichung vom u- 
+	 * bzw. v-Mittelwert besitzen, aus der Berechnung genommen
+	 */
+	else if (get_float(STDDEVIATION) > 0.0) {
+		update_candidates(state, X);
+		pack_candidates(state);
+		idw_kernel_filtered(&state->kernel, X, state->cos_min_r,
+		    state->cos_max_r, get_float(STDDEVIATION), sum);
+	}
+
+	/* 
+	 * Sonst: Berechnen der gewichteten Summen beider Stunden-Windfelder
+	 * in einem Durchlauf
+	 */
+	else {
+		/* 
+		 * Stationen, die im Berechnungsgebiet liegen koennen. Alle 
+		 * weiteren Berechnungen laufen nur ueber diese Kandidaten 
+		 * (aufsteigend nach Stationsindex).
+		 */
+		update_candidates(state, X);
+
+		/* 
+		 * Packen der Positionen und Stunden-Windfelder der 
+		 * Kandidaten, wenn sich Kandidatenliste oder wind_current
+		 * geaendert haben
+		 */
+		pack_candidates(state);
+
+		idw_kernel(&state->kernel, X, state->cos_min_r, 
+		    state->cos_max_r, sum);
+	}
+}
+
+/*
+ * Windquelle Windgitterdatei: Windvektoren beider Stunden-Windfelder an 
+ * der Position X. Liegt eine Stunde zwischen zwei Feldern der Datei, wird
+ * zwischen ihnen zeitlich linear interpoliert. Ausserhalb der Datei (Ort
+ * oder Zeit) ist das Gewicht 0.
+ */
+void
+lookup_windgrid(struct state* state, double X[], struct idw_sum* sum)
+{
+	const struct windgrid_header* header = 
+	    (const struct windgrid_header*)state->archive->windgrid;
+	double lo, la, t, u[2], v[2], u_met, v_met, rot;
+	int    k, r;
+
+	lo = rad2deg(atan2(X[1], X[0]));
+	la = rad2deg(asin(X[2] > 1 ? 1 : (X[2] < -1 ? -1 : X[2])));
+	rot = deg2rad(state->job.rot);
+
+	for (k = 0; k < 2; k++) {
+		sum->u[k] = sum->v[k] = sum->weight[k] = 0;
+
+		/* Felder vor und nach der Stunde */
+		t = (double)(state->hour[k] - header->first) / header->step;
+		r = (int)floor(t);
+		t -= r;
+
+		if ((r < 0) || (r >= header->hour_max) || 
+		    ((t > 0) && (r + 1 >= header->hour_max)))
+			continue;
+
+		if (sample_windgrid(header, r, lo, la, &u[0], &v[0]) != 0)
+			continue;
+		
+		if (t > 0) {
+			if (sample_windgrid(header, r + 1, lo, la, &u[1], 
+			    &v[1]) != 0)
+				continue;
+		}
+		else {
+			u[1] = v[1] = 0;
+		}
+
+		u_met = (1 - t) * u[0] + t * u[1];
+		v_met = (1 - t) * v[0] + t * v[1];
+
+		/* 
+		 * Umrechnen von u, v (Windrichtung wohin) in die Darstellung 
+		 * der Stationsmeldungen (Windrichtung woher) mit SPEED und ROT 
+		 * (siehe correct_wind())
+		 */
+		sum->u[k] = -state->job.speed * 
+		    (u_met * cos(rot) + v_met * sin(rot));
+		sum->v[k] = state->job.speed * 
+		    (u_met * sin(rot) - v_met * cos(rot));
+		sum->weight[k] = 1;
+	}
+}
+
+/*
+ * Einblenden des gepackten Winddatenarchivs (ARCHIVE) und Pruefen, ob es
+ * mit der aktuellen Stationsliste (Stationsnummern und Messeinheiten), 
+ * denselben Datenstrukturgroessen und derselben Byte-Reihenfolge erstellt 
+ * wurde. Die Windmeldungen sind unkorrigiert gespeichert, SPEED, ROT und 
+ * DATAUNIT werden erst in correct_wind() angewendet.
+ */
+void
+map_archive(struct archive* archive)
+{
+	const struct pack_header*  header;
+	const struct pack_station* station;
+	FILE*       fh;
+	int         i;
+	struct date first, last;
+
+	/* Ueberpruefen, ob Datei existiert */
+	if (!(fh = fopen(get_string(ARCHIVE), "rb"))) {
+		printf("Couldn't open file %s!\n", get_string(ARCHIVE));
+		exit(1);
+	}
+
+	fseek(fh, 0, SEEK_END);
+	archive->pack_size = ftell(fh);
+
+	if (archive->pack_size < (long)sizeof(struct pack_header)) {
+		printf("Archive %s: wrong format!\n", get_string(ARCHIVE));
+		exit(1);
+	}
+
+#ifdef USE_MMAP
+	/* Nur lesend einblenden, die Seiten werden bei Bedarf geladen */
+	archive->pack = mmap(NULL, archive->pack_size, PROT_READ, 
+	    MAP_SHARED, fileno(fh), 0);
+
+	if (archive->pack == MAP_FAILED) {
+		printf("Couldn't map file %s!\n", get_string(ARCHIVE));
+		exit(1);
+	}
+#else
+	/* Ohne mmap() wird das Archiv vollstaendig eingelesen */
+	archive->pack = malloc(archive->pack_size);
+	rewind(fh);
+
+	if (fread(archive->pack, 1, archive->pack_size, fh) != 
+	    (size_t)archive->pack_size) {
+		printf("Couldn't read file %s!\n", get_string(ARCHIVE));
+		exit(1);
+	}
+#endif
+	fclose(fh);
+
+	header = (const struct pack_header*)archive->pack;
+
+	/* Ueberpruefen des Formats */
+	if ((strncmp(header->magic, PACKMAGIC, sizeof(header->magic)) != 0) ||
+	    (header->version != PACKVER) || 
+	    (header->byte_order != 0x01020304) ||
+	    (header->size_header != (int)sizeof(struct pack_header)) ||
+	    (header->size_hour != (int)sizeof(struct pack_hour)) ||
+	    (header->size_report != (int)sizeof(struct report)) ||
+	    (header->station_max < 0) || (header->hour_max < 0) ||
+	    (header->first % 24 != 0) || (header->hour_max % 24 != 0) ||
+	    (header->station_offset < (long)sizeof(struct pack_header)) ||
+	    (header->hour_offset < (long)sizeof(struct pack_header)) ||
+	    (header->station_offset + header->station_max * 
+	     (long)sizeof(struct pack_station) > archive->pack_size) ||
+	    (header->hour_offset + header->hour_max * 
+	     (long)sizeof(struct pack_hour) > archive->pack_size)) {
+		printf("Archive %s: wrong format!\n", get_string(ARCHIVE));
+		exit(1);
+	}
+
+	/* Die gepackten Windmeldungen sind nach der Stationsliste indiziert */
+	station = (const struct pack_station*)(archive->pack + 
+	    header->station_offset);
+	
+	if (header->station_max != archive->station_max) {
+		i = 0;
+	}
+	else {
+		for (i = 0; i < archive->station_max; i++) {
+			if ((station[i].nr != archive->station_list[i].nr) ||
+			    (station[i].unit != 
+				archive->station_list[i].unit)) {
+				break;
+			}
+		}
+	}
+
+	if (i < archive->station_max) {
+		printf("Archive %s: packed with a different station list!\n",
+		    get_string(ARCHIVE));
+		exit(1);
+	}
+
+	hours_to_date(header->first, &first);
+	hours_to_date(header->first + header->hour_max - 1, &last);
+
+	printf("%s: %04i-%02i-%02i %02i - %04i-%02i-%02i %02i (GMT)\n", 
+	    get_string(ARCHIVE), first.year, first.month, first.day, 
+	    first.hour, last.year, last.month, last.day, last.hour);
+}
+
+/* Umrechnen auf geographischen Groessenbereich */
+void
+normalize_coords(struct state* state)
+{
+	double lo = rad2deg(state->lo[state->point]);
+	double la = rad2deg(state->la[state->point]);
+
+	/* Umrechnen der geografischen Laenge auf Wertebereich 
+	 * -180..180
+	 */
+	lo = (lo - ((int)lo / 360) * 360) / 180;
+        if (fabs(lo) > 1.0)
+                lo = (((int)lo * -1) - ((lo - (int)lo) * -1)) * 180;
+        else
+                lo *= 180;
+
+	/* Umrechnen der geografischen Breite auf Wertebereich
+	 * -90..90
+	 */
+        la = (la - ((int)la / 360) * 360) / 180;
+        if (fabs(la) > 1.0)
+                la = (((int)la * -1) - ((la - (int)la) * -1)) * 180;
+        else
+                la *= 180;
+
+        la = (la - ((int)la / 180) * 180) / 90;
+        if (fabs(la) > 1.0)
+                la = ((((int)la * -1) - ((la - (int)la) * -1)) * 90) * -1;
+        else
+                la *= 90;
+
+	/* Zurueckschreiben der umgerechneten Werte */
+	state->lo[state->point] = deg2rad(lo);
+	state->la[state->point] = deg2rad(la);
+}
+
+/* Projizieren des Vektors X auf die Einheitskugel */
+void
+normalize_vector(double* X)
+{
+	double r = sqrt(X[0] * X[0] + X[1] * X[1] + X[2] * X[2]);
 
-	for (i = 0; i < state->station_max; i++) {
-		if (get_int(TRACE) > 0) {
-			state->wind_data[i].u = 
-			    state->wind_data[state->station_max + i].u;
-			
-			state->wind_data[i].v = 
-			    state->wind_data[state->station_max + i].v;
-			
-			state->wind_data[i].p = 
-			    state->wind_data[state->station_max + i].p;
-			
-			state->wind_data[state->station_max + i].u = 
-			    winddata->wind[i].u;
-			
-			state->wind_data[state->station_max + i].v = 
-			    winddata->wind[i].v;
-			
-			state->wind_data[state->station_max + i].p = 
-			    winddata->wind[i].p;
-		}
-		else {
-			
-			state->wind_data[state->station_max + i].u = 
-			    state->wind_data[i].u;
-			
-			state->wind_data[state->station_max + i].v = 
-			    state->wind_data[i].v; 
-			
-			state->wind_data[state->station_max + i].p = 
-			    state->wind_data[i].p;
-			
-			state->wind_data[i].u = 
-			    winddata->wind[i].u;
-			
-			state->wind_data[i].v = 
-			    winddata->wind[i].v;
-			
-			state->wind_data[i].p = 
-			    winddata->wind[i].p;
-		}
-	}
-	
-	return winddata;
+	X[0] /= r;
+	X[1] /= r;
+	X[2] /= r;
 }
 
-/* Zum vorherigen Listenelement in der Kette springen
- * Rueckgabewert ist das vorherige Listenelement
+/*
+ * Windquelle Stationsmeldungen: Einlesen der von allen Auftraegen 
+ * gemeinsam genutzten Eingabedaten (Stationsliste und Winddaten)
  */
-struct winddata*
-get_prev_element(struct winddata* winddata)
+void
+open_stations(struct archive* archive, const struct job* job, int job_max)
 {
-	do {
-		winddata = winddata->prev;
-		if (winddata == NULL) {
-			printf("get_prev_element: end of list!\n");
-			exit(1);
-		}
-	} while (winddata->wind == NULL);
-	
-	return winddata;
+#ifdef USE_PTHREAD
+	pthread_mutex_init(&archive->grids.lock, NULL);
+	pthread_mutex_init(&archive->meshes.lock, NULL);
+#endif
+
+	/* 
+	 * Einlesen der Stationsinformationen in die Datenstruktur 
+	 * archive->station_list 
+	 */
+	read_station_list(archive);
+
+	/* Einblenden des gepackten Winddatenarchivs, wenn angegeben */
+	if (strlen(get_string(ARCHIVE)) > 0) {
+		map_archive(archive);
+	}
+
+	/* 
+	 * Sammeln der fuer alle Auftraege benoetigten Winddaten 
+	 * (Daten-Windfelder)
+	 */
+	read_wind_data(archive, job, job_max);
 }
 
-/* 
- * Initialisieren der Datenstruktur zum Abbilden des programminternen 
- * Berechnungsstatus
+/*
+ * Windquelle Windgitterdatei: Einblenden der Windgitterdatei WINDGRID und
+ * Pruefen ihres Kopfes (siehe struct windgrid_header)
  */
 void
-init_values(struct state* state)
+open_windgrid(struct archive* archive, const struct job* job, int job_max)
 {
-	memset(state, 0, sizeof(struct state));
+	const struct windgrid_header* header;
+	FILE*       fh;
+	struct date first, last;
 
-	state->distance_per_step = 3.6 / (get_int(IPERH) * RE);
-	state->cos_max_r = cos(get_int(MAXR) / RE);
-	state->cos_min_r = cos(get_int(MINR) / RE);
-	state->station_max = get_amount_of_stations(state);
-	state->point_max = (int)((double)get_int(IPERH) / 
-	    (double)get_int(IPERPOINT) *
-	    (double)abs(get_int(TRACE)));
-	state->point = 0;
+	/* Die Auftraege werden fuer die Windgitterdatei nicht benoetigt */
+	(void)job; (void)job_max;
 
-	state->lo = calloc(state->point_max + 1, sizeof(double));
-	state->la = calloc(state->point_max + 1, sizeof(double));
+	if (!(fh = fopen(get_string(WINDGRID), "rb"))) {
+		printf("Couldn't open file %s!\n", get_string(WINDGRID));
+		exit(1);
+	}
 
-	state->wind_data = calloc(2 * state->station_max,
-	    sizeof(struct wind));
-	state->wind_current = calloc(2 * state->station_max,
-	    sizeof(struct wind));
-	state->station_list = calloc(state->station_max,
-	    sizeof(struct station));
+	fseek(fh, 0, SEEK_END);
+	archive->windgrid_size = ftell(fh);
 
-	state->time.year = get_int(YYYY);
-	state->time.month = get_int(MM);
-	state->time.day = get_int(DD);
-	state->time.hour = get_int(HH);
+	if (archive->windgrid_size < (long)sizeof(struct windgrid_header)) {
+		printf("Wind grid %s: wrong format!\n", get_string(WINDGRID));
+		exit(1);
+	}
 
-	state->lo[0] = deg2rad(get_float(LO));
-	state->la[0] = deg2rad(get_float(LA));
+#ifdef USE_MMAP
+	/* Nur lesend einblenden, die Seiten werden bei Bedarf geladen */
+	archive->windgrid = mmap(NULL, archive->windgrid_size, PROT_READ, 
+	    MAP_SHARED, fileno(fh), 0);
 
-	/* Umrechnen der Startposition auf geographischen Groessenbereich */
-	normalize_coords(state);
+	if (archive->windgrid == MAP_FAILED) {
+		printf("Couldn't map file %s!\n", get_string(WINDGRID));
+		exit(1);
+	}
+#else
+	/* Ohne mmap() wird die Datei vollstaendig eingelesen */
+	archive->windgrid = malloc(archive->windgrid_size);
+	rewind(fh);
+
+	if (fread(archive->windgrid, 1, archive->windgrid_size, fh) != 
+	    (size_t)archive->windgrid_size) {
+		printf("Couldn't read file %s!\n", get_string(WINDGRID));
+		exit(1);
+	}
+#endif
+	fclose(fh);
+
+	header = (const struct windgrid_header*)archive->windgrid;
+
+	/* Ueberpruefen des Formats */
+	if ((strncmp(header->magic, WINDGRIDMAGIC, 
+	    sizeof(header->magic)) != 0) ||
+	    (header->version != WINDGRIDVER) || 
+	    (header->byte_order != 0x01020304) ||
+	    (header->lo_max < 2) || (header->la_max < 2) || 
+	    (header->hour_max < 1) || (header->step < 1) ||
+	    (header->lo_step <= 0) || (header->la_step <= 0) ||
+	    (archive->windgrid_size != (long)sizeof(struct windgrid_header) + 
+	     2L * header->hour_max * header->lo_max * header->la_max * 
+	     (long)sizeof(float))) {
+		printf("Wind grid %s: wrong format!\n", get_string(WINDGRID));
+		exit(1);
+	}
+
+	hours_to_date(header->first, &first);
+	hours_to_date(header->first + (header->hour_max - 1) * header->step,
+	    &last);
+
+	printf("%s: %04i-%02i-%02i %02i - %04i-%02i-%02i %02i (GMT), "
+	    "%i x %i points\n", get_string(WINDGRID), first.year, 
+	    first.month, first.day, first.hour, last.year, last.month, 
+	    last.day, last.hour, header->lo_max, header->la_max);
 }
 
 /*
- * Erstellen der ersten beiden Daten-Windfelder fuer die zeitliche
- * Interpolation waehrend der Trajektorienberechnung
+ * Packen aller Tagesdatensaetze (bYYMMDD.new) des Verzeichnisses METEO in
+ * das Winddatenarchiv PACK. Die Windmeldungen werden wie beim Einlesen mit
+ * read_file() der Stationsliste zugeordnet, aber nicht korrigiert, so dass
+ * das Archiv fuer beliebige SPEED, ROT und DATAUNIT verwendet werden kann.
+ *
+ * Aufbau des Archivs: struct pack_header, Stationstabelle, Stundenindex
+ * (jede Stunde vom ersten bis zum letzten Tag) und die ab einer 8-Byte-
+ * Grenze lueckenlos folgenden Windfelder. Die Windfelder werden genau so
+ * geschrieben, wie sie im Speicher vorliegen (Liste der Stationen mit 
+ * Daten).
  */
-struct winddata*
-init_wind_data(struct state* state, struct winddata* winddata)
+void
+pack_archive(void)
 {
-	struct date time_dummy; /* Letzte gueltige Zeitangabe */
-	int i;
+	static const char   zero[8];
+	struct archive      archive;
+	struct pack_header  header;
+	struct pack_station station;
+	struct pack_hour*   hour;
+	struct dirent*      entry;
+	struct field*       field;
+	struct date         time;
+	DIR*   dir;
+	FILE*  fh;
+	char*  d;
+	int    i, j, k, day_max, size, hour_count;
+	int*   day;
+	long   offset;
+
+	/* Einlesen der Stationsliste */
+	memset(&archive, 0, sizeof(struct archive));
+#ifdef USE_PTHREAD
+	pthread_mutex_init(&archive.grids.lock, NULL);
+	pthread_mutex_init(&archive.meshes.lock, NULL);
+#endif
+	read_station_list(&archive);
+
+	/* Suchen der Tagesdatensaetze im Verzeichnis METEO */
+	if (!(dir = opendir(get_string(METEO)))) {
+		printf("Couldn't open directory %s!\n", get_string(METEO));
+		exit(1);
+	}
 
-	/*
-	 * Einlesen des ersten Daten-Windfeldes.
-	 *
-	 * Bis Dateiende erreicht oder Windfeld eingelesen ist, das am
-	 * naechsten zum Berechunungsstartzeitpunkt lieg (relativ zur
-	 * Berechnugnsrichtung vorher oder gleich).
-	 */
-	while (!(time_equal(state->time, winddata->time))) {
-		winddata = winddata->next;
-	
-		if (winddata == NULL) {
-			printf("init_wind_data: end of list!\n");
-			exit(1);
+	size = 16;
+	day = calloc(size, sizeof(int));
+	day_max = 0;
+
+	while ((entry = readdir(dir)) != NULL) {
+		d = entry->d_name;
+
+		/* bYYMMDD.new, auch komprimiert (.gz, .zst) */
+		if ((strlen(d) < 11) || (d[0] != 'b') ||
+		    (strncmp(d + 7, ".new", 4) != 0) ||
+		    ((d[11] != '\0') && (strcmp(d + 11, ".gz") != 0) &&
+		     (strcmp(d + 11, ".zst") != 0)))
+			continue;
+
+		for (i = 1; (i < 7) && isdigit((unsigned char)d[i]); i++)
+			;
+		if (i < 7)
+			continue;
+
+		/* 99 -> 1999, 07 -> 2007 (Jahre 1950 bis 2049) */
+		time.year = (d[1] - '0') * 10 + (d[2] - '0');
+		time.year += (time.year < 50) ? 2000 : 1900;
+		time.month = (d[3] - '0') * 10 + (d[4] - '0');
+		time.day = (d[5] - '0') * 10 + (d[6] - '0');
+		time.hour = 0;
+
+		/* Wenn Tagesliste zu klein ist */
+		if (day_max == size) {
+			size *= 2;
+			day = realloc(day, size * sizeof(int));
 		}
+
+		day[day_max] = hour_to_day(date_to_hours(&time));
+		day_max += 1;
 	}
+	closedir(dir);
 
-	state->diff = state->data_diff = 0;
-	
-	/* Wenn Daten zur Startzeit vorhanden sind */
-	if(winddata->wind == NULL) {
+	if (day_max == 0) {
+		printf("No wind data in directory %s!\n", get_string(METEO));
+		exit(1);
+	}
 
-		time_dummy.year = winddata->time.year;
-		time_dummy.month = winddata->time.month;
-		time_dummy.day = winddata->time.day;
-		time_dummy.hour = winddata->time.hour;
-		
-		if (get_int(TRACE) > 0)
-			winddata = get_prev_element(winddata);
-		else 
-			winddata = get_next_element(winddata);
-		
-		while (!time_equal(time_dummy, winddata->time)) {
-			time_step_backward(&time_dummy);
-			state->diff += 1;
-		}
+	qsort(day, day_max, sizeof(int), compare_int);
+
+	/* Tage, die in mehreren Varianten vorliegen, nur einmal */
+	for (i = j = 0; i < day_max; i++) {
+		if ((j == 0) || (day[i] != day[j - 1]))
+			day[j++] = day[i];
+	}
+	day_max = j;
+
+	/* Archivkopf */
+	memset(&header, 0, sizeof(struct pack_header));
+	memcpy(header.magic, PACKMAGIC, sizeof(PACKMAGIC));
+	header.version = PACKVER;
+	header.byte_order = 0x01020304;
+	header.size_header = sizeof(struct pack_header);
+	header.size_hour = sizeof(struct pack_hour);
+	header.size_report = sizeof(struct report);
+	header.station_max = archive.station_max;
+	header.first = day[0] * 24;
+	header.hour_max = (day[day_max - 1] - day[0] + 1) * 24;
+	header.station_offset = sizeof(struct pack_header);
+	header.hour_offset = header.station_offset +
+	    archive.station_max * sizeof(struct pack_station);
+
+	/* Stundenindex, Stunden ohne Tagesdatei bleiben PACK_MISSING */
+	hour = calloc(header.hour_max, sizeof(struct pack_hour));
+	for (i = 0; i < header.hour_max; i++) {
+		hour[i].kind = PACK_MISSING;
 	}
 
-	for (i = 0; i < state->station_max; i++) {
-		state->wind_data[i].u = 
-		    winddata->wind[i].u;
-		
-		state->wind_data[i].v = 
-		    winddata->wind[i].v;
-		
-		state->wind_data[i].p = 
-		    winddata->wind[i].p;
+	if (!(fh = fopen(get_string(PACK), "wb"))) {
+		printf("Couldn't open file %s!\n", get_string(PACK));
+		exit(1);
 	}
 
-	time_dummy.year = winddata->time.year;
-	time_dummy.month = winddata->time.month;
-	time_dummy.day = winddata->time.day;
-	time_dummy.hour = winddata->time.hour;
+	fwrite(&header, sizeof(struct pack_header), 1, fh);
+
+	for (i = 0; i < archive.station_max; i++) {
+		station.nr = archive.station_list[i].nr;
+		station.unit = archive.station_list[i].unit;
+		fwrite(&station, sizeof(struct pack_station), 1, fh);
+	}
 
-	if (get_int(TRACE) > 0)
-		winddata = get_next_element(winddata);
-	else 
-		winddata = get_prev_element(winddata);
+	/*
+	 * Platzhalter fuer den Stundenindex, der nach den Datenbloecken
+	 * geschrieben wird
+	 */
+	fwrite(hour, sizeof(struct pack_hour), header.hour_max, fh);
+	offset = header.hour_offset +
+	    header.hour_max * (long)sizeof(struct pack_hour);
+	fwrite(zero, 1, (8 - offset % 8) % 8, fh);
+	offset += (8 - offset % 8) % 8;
+
+	/* Zeitfolge fuer jeweils einen Tag */
+	archive.timeline.hour_max = 24;
+	archive.timeline.field = calloc(24, sizeof(struct field));
+	hour_count = 0;
+
+	for (i = 0; i < day_max; i++) {
+		archive.timeline.first = day[i] * 24;
+		read_day(&archive, day[i]);
+
+		for (j = 0; j < 24; j++) {
+			k = archive.timeline.first - header.first + j;
+			field = &archive.timeline.field[j];
+
+			if (field->report == NULL) {
+				hour[k].kind = PACK_NONE;
+				continue;
+			}
 
-	while (!time_equal(time_dummy, winddata->time)) {
-		time_step_forward(&time_dummy);
-		state->data_diff += 1;
+			/* Windfeld unveraendert (Liste) schreiben */
+			hour[k].kind = PACK_FIELD;
+			hour[k].offset = offset;
+			hour[k].count = field->n;
+			fwrite(field->report, sizeof(struct report), field->n,
+			    fh);
+			offset += field->n * sizeof(struct report);
+			hour_count++;
+
+			free(field->report);
+			field->report = NULL;
+		}
 	}
-	
-	for (i = 0; i < state->station_max; i++) {
-		state->wind_data[state->station_max + i].u = 
-		    winddata->wind[i].u;
-		
-		state->wind_data[state->station_max + i].v = 
-		    winddata->wind[i].v;
-		
-		state->wind_data[state->station_max + i].p = 
-		    winddata->wind[i].p;
+
+	/* Stundenindex schreiben */
+	fseek(fh, header.hour_offset, SEEK_SET);
+	fwrite(hour, sizeof(struct pack_hour), header.hour_max, fh);
+
+	if (ferror(fh) || (fclose(fh) != 0)) {
+		printf("Couldn't write file %s!\n", get_string(PACK));
+		exit(1);
 	}
-	
-	if (get_int(TRACE) < 0) {
-		winddata = winddata->next;
-		while (winddata->wind == NULL)
-			winddata = winddata->next;
+
+	printf("%s: %i days, %i hours with wind data, %li bytes\n",
+	    get_string(PACK), day_max, hour_count, offset);
+
+	/* Winddatenzeilen unbekannter Stationen melden */
+	if (archive.unknown_count > 0) {
+		printf("%i wind records of stations not in %s ignored\n",
+		    archive.unknown_count, get_string(STATION));
 	}
 
-	return winddata;
+	/* Speicher freigeben */
+	free(hour);
+	free(day);
+	reset_archive(&archive);
 }
 
-/* Iterieren bis zum naechsten Trajektorienaufpunkt */
+/*
+ * Packen der Positionen und der beiden Stunden-Windfelder (wind_current)
+ * der Kandidatenstationen in die Felder des IDW-Kerns. Es wird nur gepackt,
+ * wenn sich die Kandidatenliste oder wind_current seit dem letzten Packen 
+ * geaendert haben. Kandidaten ohne Daten in beiden Stunden-Windfeldern 
+ * tragen nichts zur Interpolation bei und werden weggelassen.
+ */
 void
-iterate(struct state *state, struct winddata** winddata)
+pack_candidates(struct state* state)
 {
-	int    j; 
-        
-        /* 
-	 * Anzahl der durchlaufenen Iterationen seit der letzten vollen 
-	 * Zeitstunde 
-	 */
-	int    iteration; 
+	struct kernel*        kernel = &state->kernel;
+	const struct station* station_list = state->archive->station_list;
+	const struct wind*    wind1 = state->wind_current[0].wind;
+	const struct wind*    wind2 = state->wind_current[1].wind;
+	int                   i, j1, j2, k, n;
+
+	if ((kernel->rebuild == state->candidate_count) &&
+	    (kernel->hour == state->hour_count)) {
+		return;
+	}
 
-	/* Windvektor der momentanen Berechnungsposition */
-	double u, v;
-	
-	/* 
-	 * Zeitverzatz in Stundenanteilen, seit der letzten vollen 
-	 * Zeitstunde 
-	 */
-	double hour_diff;
+	for (k = n = 0; k < state->candidate_max; k++) {
+		i = state->candidate[k];
+		j1 = state->slot[0][i];
+		j2 = state->slot[1][i];
+
+		if ((j1 < 0) && (j2 < 0))
+			continue;
+
+		kernel->x[n] = station_list[i].X[0];
+		kernel->y[n] = station_list[i].X[1];
+		kernel->z[n] = station_list[i].X[2];
+
+		kernel->u1[n] = (j1 < 0) ? 0 : wind1[j1].u;
+		kernel->v1[n] = (j1 < 0) ? 0 : wind1[j1].v;
+		kernel->m1[n] = (j1 >= 0);
+		kernel->u2[n] = (j2 < 0) ? 0 : wind2[j2].u;
+		kernel->v2[n] = (j2 < 0) ? 0 : wind2[j2].v;
+		kernel->m2[n] = (j2 >= 0);
+		n++;
+	}
 
-	/* Momentane Berechnungsposition {kartesisch 3D) */
-	double X[3];
+	/* Auffuellen auf ein Vielfaches von LANES */
+	kernel->n = (n + LANES - 1) / LANES * LANES;
+	for (k = n; k < kernel->n; k++) {
+		kernel->x[k] = kernel->y[k] = kernel->z[k] = 0;
+		kernel->u1[k] = kernel->v1[k] = kernel->m1[k] = 0;
+		kernel->u2[k] = kernel->v2[k] = kernel->m2[k] = 0;
+	}
 
-	/* 
-	 * Iterieren bis Iterationszahl fuer naechsten Aufpunkt erreicht 
-	 * ist 
-	 */
-	for (j = 0; j < get_int(IPERPOINT); j++) {
+	kernel->rebuild = state->candidate_count;
+	kernel->hour = state->hour_count;
+}
 
-		/* 
-		 * Berechnung der Iterationsanzahl seit letzter vollen 
-		 * Zeitstunde 
-		 */
-		iteration = ((state->point - 1) * get_int(IPERPOINT) + j) % 
-		    get_int(IPERH);
+/*
+ * Uebernehmen der gepackten Kandidaten des Mitglieds j (siehe 
+ * pack_candidates()) in seine Spur der verschraenkten Felder. Es wird nur
+ * uebernommen, wenn neu gepackt wurde. Ist die Trajektorie nicht (mehr)
+ * aktiv, wird die Spur geleert.
+ */
+void
+pack_lane(struct lockstep* group, int j)
+{
+	struct state*  state = &group->member[j];
+	struct kernel* kernel = &state->kernel;
+	int            i, k, n = 0;
+
+	if ((state->point > 0) && (state->point <= state->point_max)) {
+		if ((kernel->rebuild == state->candidate_count) &&
+		    (kernel->hour == state->hour_count)) {
+			return;
+		}
+		pack_candidates(state);
+		n = kernel->n;
+	}
+	else {
+		group->X[0][j] = group->X[1][j] = group->X[2][j] = 0;
+		group->cos_min_r[j] = 1.0;
+		group->cos_max_r[j] = 2.0;
+	}
 
-		/* Wenn naechste volle Zeitstunde erreicht ist ... */
-		if (iteration == 0) {
-			
-			if (get_int(TRACE) > 0)
-				state->diff += 1;
-			else
-				state->diff -= 1;
-		
-			/* 
-			 * Umkopieren des vorher "zukuenftigen" 
-			 * Stunden-Windfeldes (wind_current[0]) als 
-			 * "momentanes/vergangenes" Stunden-Windfeld 
-			 * (wind_curren[1]) 
-			 */
-			copy_wind_current(state);
+	for (k = 0; k < n; k++) {
+		i = k * group->lane_max + j;
+		group->x[i] = kernel->x[k];
+		group->y[i] = kernel->y[k];
+		group->z[i] = kernel->z[k];
+		group->u1[i] = kernel->u1[k];
+		group->v1[i] = kernel->v1[k];
+		group->m1[i] = kernel->m1[k];
+		group->u2[i] = kernel->u2[k];
+		group->v2[i] = kernel->v2[k];
+		group->m2[i] = kernel->m2[k];
+	}
 
-			/* Wenn das naechste Daten-Windfeld erreicht ist */
-			if ((state->diff == state->data_diff) || 
-			    (state->diff == -1)) { 
+	/* Rest der bisherigen Kandidaten leeren */
+	for (k = n; k < group->lane_n[j]; k++) {
+		i = k * group->lane_max + j;
+		group->x[i] = group->y[i] = group->z[i] = 0;
+		group->u1[i] = group->v1[i] = group->m1[i] = 0;
+		group->u2[i] = group->v2[i] = group->m2[i] = 0;
+	}
 
-				/* 
-				 * Verschieben des Zeitfensters (wind_data) 
-				 * um state->delta_diff in Berechnungsrich-
-				 * tung (lese neues Daten-Windfeld ein)
-				 */
-				*winddata = get_next_wind_data(state, *winddata);
-				
-				/* 
-				 * Ueberpruefen, ob die angegeben zeitliche 
-				 * Datenaufloesung mit vorhandeneer Datenauf-
-				 * loesung uebereinstimmt
-				 */
-				check_resolution(get_int(RES), 
-				    state->data_diff);
-				
-				/* 
-				 * Setze den Zeitunterschied (state->diff) 
-				 * zum Daten-Windfeld auf 0 
-				 */
-				if (get_int(TRACE) > 0)
-					state->diff = 0;
-				else
-					state->diff = state->data_diff - 1;
-				
-			}
-			
-			/* 
-			 * Generieren des naechsten "zukuenftigen" 
-			 * Stunden-Windfeldes (wind_current[0]) 
-			 */
-			wind_of_next_hour(state);
-			
-		}
+	group->lane_n[j] = n;
+}
 
-		/* 
-		 * Berechnen des Stundenanteils seit der letzten vollen 
-		 * Zeitstunde (0 <= hour_diff < 1) 
-		 */
-		hour_diff = (double)iteration / (double)get_int(IPERH);
+/*
+ * Packen der KNEAREST naechsten Stationen mit Daten jedes der beiden 
+ * Stunden-Windfelder an der Position X fuer den IDW-Kern. Gepackt wird 
+ * die Vereinigung beider Auswahlen aufsteigend nach Stationsindex; die 
+ * Masken m1 und m2 enthalten nur die Auswahl des jeweiligen Stunden-
+ * Windfelds.
+ */
+void
+pack_nearest(struct state* state, double X[])
+{
+	struct kernel*        kernel = &state->kernel;
+	const struct station* station_list = state->archive->station_list;
+	const struct wind*    wind1 = state->wind_current[0].wind;
+	const struct wind*    wind2 = state->wind_current[1].wind;
+	int*                  select1 = state->nearest;
+	int*                  select2 = state->nearest + state->nearest_max;
+	int*                  list = state->nearest + 2 * state->nearest_max;
+	int                   i, j1, j2, k, n, m1, m2;
+
+	m1 = select_nearest(state, X, 0, select1, state->nearest_cos);
+	m2 = select_nearest(state, X, 1, select2, state->nearest_cos);
+
+	/* Vereinigung beider Auswahlen aufsteigend nach Stationsindex */
+	memcpy(list, select1, m1 * sizeof(int));
+	memcpy(list + m1, select2, m2 * sizeof(int));
+	qsort(list, m1 + m2, sizeof(int), compare_int);
+
+	for (k = n = 0; k < m1 + m2; k++) {
+		i = list[k];
+
+		if ((k > 0) && (list[k - 1] == i))
+			continue;
+
+		for (j1 = 0; (j1 < m1) && (select1[j1] != i); j1++)
+			;
+		for (j2 = 0; (j2 < m2) && (select2[j2] != i); j2++)
+			;
+
+		kernel->x[n] = station_list[i].X[0];
+		kernel->y[n] = station_list[i].X[1];
+		kernel->z[n] = station_list[i].X[2];
+
+		kernel->u1[n] = (j1 < m1) ? wind1[state->slot[0][i]].u : 0;
+		kernel->v1[n] = (j1 < m1) ? wind1[state->slot[0][i]].v : 0;
+		kernel->m1[n] = (j1 < m1);
+		kernel->u2[n] = (j2 < m2) ? wind2[state->slot[1][i]].u : 0;
+		kernel->v2[n] = (j2 < m2) ? wind2[state->slot[1][i]].v : 0;
+		kernel->m2[n] = (j2 < m2);
+		n++;
+	}
 
-		/* 
-		 * Umrechnen der momentanen Berechnungskoordinaten 
-		 * (state->lo, state->la) in kartesische 3D-Koordinaten (X) 
-		 */
-		convert_geo_to_cartesian(state->lo[state->point], 
-		    state->la[state->point], X);
+	/* Auffuellen auf ein Vielfaches von LANES */
+	kernel->n = (n + LANES - 1) / LANES * LANES;
+	for (k = n; k < kernel->n; k++) {
+		kernel->x[k] = kernel->y[k] = kernel->z[k] = 0;
+		kernel->u1[k] = kernel->v1[k] = kernel->m1[k] = 0;
+		kernel->u2[k] = kernel->v2[k] = kernel->m2[k] = 0;
+	}
 
-		/* 
-		 * Berechnen des interpolierten Windvektors fuer momentane 
-		 * Position (X) 
-		 */
-		if (calculate_wind_vector(hour_diff, &u, &v, X, state) == 1) {
-			/* 
-			 * Wenn kein Windvektor berechnet werden konnte, 
-			 * breche Berechnung ab 
-			 */
-			state->point_max = state->point;
-			j = get_int(IPERPOINT);
-		}
+	/* Gepackte Kandidatenfelder sind nicht mehr gueltig */
+	kernel->rebuild = -1;
+}
 
-		/* 
-		 * Berechnung des raeumlichen Versatzes fuer diesen 
-		 * Interpolationsschritt 
-		 */
-		state->lo[state->point] = state->lo[state->point] + 
-		    state->distance_per_step * u / 
-		    cos(state->la[state->point]);
-		
-		state->la[state->point] = state->la[state->point] + 
-		    state->distance_per_step * v;
+/*
+ * Anfordern des Vorausladens eines Tages der Zeitfolge (Tagesindex d in 
+ * archive->timeline) durch den Vorauslade-Thread. Eine noch nicht 
+ * begonnene fruehere Anforderung wird dabei ersetzt.
+ */
+void
+prefetch_day(struct archive* archive, int d)
+{
+#ifdef USE_PTHREAD
+	struct day_cache* cache = &archive->cache;
+
+	if ((cache->prefetch == 0) || (d < 0) || (d >= cache->day_max))
+		return;
+
+	pthread_mutex_lock(&cache->lock);
+	if ((cache->needed[d] != 0) && (cache->loaded[d] == 0) &&
+	    (cache->loading[d] == 0) &&
+	    (cache->slot[0].day != d) && (cache->slot[1].day != d)) {
+		cache->request = d;
+		pthread_cond_signal(&cache->wake);
 	}
+	pthread_mutex_unlock(&cache->lock);
+#else
+	(void)archive; (void)d;
+#endif
 }
 
-/* Initialisieren der Datenstruktur zum Speichern von
- * Windfeldern
+/*
+ * Anfordern des Vorausladens des Tages, mit dem die Trajektorie eines 
+ * Auftrags beginnt (Startzeit, in Berechnungsrichtung zurueck um RES wie 
+ * in collect_days()). In einer Zeitreihe (SERIES) von Rueckwaerts-
+ * trajektorien liegt dieser Tag vor allen bisher gehaltenen Tagen und 
+ * wird von hold_days() nie angefordert.
  */
-struct winddata*
-new_winddata(void)
+void
+prefetch_job(struct archive* archive, const struct job* job)
 {
-	struct winddata* winddata;
+	int hour, res;
+
+	if (archive->cache.ref == NULL)
+		return;
 
-	winddata = malloc(sizeof(struct winddata));
-	winddata->time.year = 0;
-	winddata->time.month = 0;
-	winddata->time.day = 0;
-	winddata->time.hour = 0;
-	winddata->wind = NULL;
-	winddata->next = NULL;
-	winddata->prev = NULL;
+	res = (get_int(RES) == 0) ? RESMAX : get_int(RES);
+	hour = convert_timezone(&job->time) - archive->timeline.first;
+	hour += (job->trace < 0) ? res : -res;
 
-	return winddata;
+	prefetch_day(archive, hour_to_day(hour));
 }
 
-/* Umrechnen auf geographischen Groessenbereich */
-void
-normalize_coords(struct state* state)
+/*
+ * Hauptfunktion des Vorauslade-Threads: Einlesen des jeweils angeforderten
+ * Tages in einen freien Vorausladepuffer, bis cache->stop gesetzt wird.
+ * Das Einlesen geschieht ohne cache->lock, die Trajektorien rechnen
+ * waehrenddessen weiter. Sind beide Puffer belegt, wird der aeltere noch 
+ * nicht uebernommene Tag verworfen.
+ */
+void*
+prefetch_main(void* arg)
 {
-	double lo = rad2deg(state->lo[state->point]);
-	double la = rad2deg(state->la[state->point]);
+#ifdef USE_PTHREAD
+	struct archive*   archive = arg;
+	struct day_cache* cache = &archive->cache;
+	struct prefetch*  slot;
+	int               d;
 
-	/* Umrechnen der geografischen Laenge auf Wertebereich 
-	 * -180..180
-	 */
-	lo = (lo - ((int)lo / 360) * 360) / 180;
-        if (fabs(lo) > 1.0)
-                lo = (((int)lo * -1) - ((lo - (int)lo) * -1)) * 180;
-        else
-                lo *= 180;
+	pthread_mutex_lock(&cache->lock);
 
-	/* Umrechnen der geografischen Breite auf Wertebereich
-	 * -90..90
-	 */
-        la = (la - ((int)la / 360) * 360) / 180;
-        if (fabs(la) > 1.0)
-                la = (((int)la * -1) - ((la - (int)la) * -1)) * 180;
-        else
-                la *= 180;
+	while (cache->stop == 0) {
+
+		d = cache->request;
+		cache->request = -1;
+
+		/* Wenn nichts (mehr) vorauszuladen ist */
+		if ((d < 0) || (cache->loaded[d] != 0) || 
+		    (cache->loading[d] != 0) ||
+		    (cache->slot[0].day == d) || (cache->slot[1].day == d)) {
+			pthread_cond_wait(&cache->wake, &cache->lock);
+			continue;
+		}
+
+		/* Freien Puffer waehlen, sonst den aelteren verwerfen */
+		if (cache->slot[0].state == PREFETCH_EMPTY)
+			slot = &cache->slot[0];
+		else if (cache->slot[1].state == PREFETCH_EMPTY)
+			slot = &cache->slot[1];
+		else if (cache->slot[0].seq < cache->slot[1].seq)
+			slot = &cache->slot[0];
+		else
+			slot = &cache->slot[1];
 
-        la = (la - ((int)la / 180) * 180) / 90;
-        if (fabs(la) > 1.0)
-                la = ((((int)la * -1) - ((la - (int)la) * -1)) * 90) * -1;
-        else
-                la *= 90;
+		drop_prefetch(slot);
+		slot->day = d;
+		slot->state = PREFETCH_LOADING;
 
-	/* Zurueckschreiben der umgerechneten Werte */
-	state->lo[state->point] = deg2rad(lo);
-	state->la[state->point] = deg2rad(la);
+		pthread_mutex_unlock(&cache->lock);
+
+		decode_day(archive, archive->timeline.first / 24 + d, slot);
+
+		pthread_mutex_lock(&cache->lock);
+
+		cache->seq += 1;
+		slot->seq = cache->seq;
+		slot->state = PREFETCH_READY;
+		pthread_cond_broadcast(&cache->done);
+	}
+
+	pthread_mutex_unlock(&cache->lock);
+#else
+	(void)arg;
+#endif
+	return NULL;
 }
 
 /* 
@@ -1419,51 +6702,26 @@ normalize_coords(struct state* state)
  * benoetigt werden 
  */
 void
-prepare_calculate(struct state* state, struct winddata** winddata) {
-
-	/* Umrechnung von externer Zeitzone in interne Zeitzone (GMT) */
-	convert_timezone(state);
-
-	/* 
-	 * Einlesen der Stationsinformationen in die Datenstruktur 
-	 * state->station_list 
-	 */
-	read_station_list(state);
+prepare_calculate(struct state* state) {
 
 	/* 
 	 * Distanzberechnungsfaktor (distance_per_step) fuer 
 	 * Berechnungsrichtung anpassen (rueckwaerts => negativ) 
 	 */
-	if (get_int(TRACE) > 0) { 
+	if (state->job.trace > 0) { 
 		state->distance_per_step *= -1;
 	}
-	if (get_int(TRACE) == 0) {
+	if (state->job.trace == 0) {
 		printf("Error: TRACE = 0!\n");
 		exit (1);
 	}
+	if ((get_int(INTEGRATOR) < 0) || (get_int(INTEGRATOR) > 2)) {
+		printf("Unknown value for INTEGRATOR!\n");
+		exit(1);
+	}
 
-	/* 
-	 * Sammeln der fuer die Berechnung benoetigten Winddaten 
-	 * (Daten-Windfelder) in der temporaeren Sammeldatei 
-	 */
-	*winddata = new_winddata();
-	read_wind_data(state, *winddata);
-
-	/*
-	 * Einlesen der ersten fuer die Berechnung benoetigten 2 
-	 * Daten-Windfelder in die Datenstruktur state->wind_data
-	 */
-	*winddata = init_wind_data(state, *winddata);
-
-	/* Ueberpruefen, ob die angegebenen Datensatzaufloesung korrekt ist */
-	check_resolution(get_int(RES), state->data_diff);
-
-	/* 
-	 * Erzeugung des ersten interpolierten Stunden-Windfeldes 
-	 * (state->wind_current) zur momentanen Berechnunszeitstunde aus den 
-	 * Daten-Windfeldern 
-	 */
-	wind_of_next_hour(state);
+	/* Stunden-Windfeld zur Startzeit bereitstellen */
+	wind_source->begin(state);
 }
 
 /* Ausgabe der berechneten Trajektorie in einer Datei */
@@ -1476,7 +6734,7 @@ print_output_file(const struct state* state)
 
 	/* Generieren des Namens der Trajektorienausgabedatei */
 	filename = malloc(MAXLINE);
-	if (generate_output_filename(filename, MAXLINE) >= MAXLINE) {
+	if (generate_output_filename(state, filename, MAXLINE) >= MAXLINE) {
 		printf("Linebuffer too small!\n");
 		exit(1);
 	}
@@ -1490,22 +6748,51 @@ print_output_file(const struct state* state)
 
 	/* Schreiben der Ausgabedatei */
 	fprintf(fh, "YYYY=%4i | MM=%2i | DD=%2i | HH=%2i | ",
-	    get_int(YYYY), get_int(MM), get_int(DD), get_int(HH));
+	    state->job.time.year, state->job.time.month, 
+	    state->job.time.day, state->job.time.hour);
 	fprintf(fh, "ZONEDIFF=%i | ZONENAME=%s\n",
 	    get_int(ZONEDIFF), get_string(ZONENAME));
 
 	fprintf(fh, "LO=%8.4f | LA=%8.4f | IPERH=%i | IPERPOINT=%i | ",
-	    get_float(LO), get_float(LA),
+	    state->job.lo, state->job.la,
 	    get_int(IPERH), get_int(IPERPOINT));
-	fprintf(fh, "TRACE=%i\n", get_int(TRACE));
+	fprintf(fh, "TRACE=%i\n", state->job.trace);
 	
 	fprintf(fh, "MINR=%i | MAXR=%i | STDDEVIATION=%6.3f | RES=%i | ",
-	    get_int(MINR), get_int(MAXR), get_float(STDDEVIATION),
+	    state->job.minr, state->job.maxr, get_float(STDDEVIATION),
 	    get_int(RES));
-	fprintf(fh, "DATAUNIT=%i\n", get_int(DATAUNIT));
+	fprintf(fh, "DATAUNIT=%i | WEIGHTMODE=%i\n", get_int(DATAUNIT),
+	    get_int(WEIGHTMODE));
+
+	fprintf(fh, "SPEED=%4.2f | ROT=%5.2f",
+	    state->job.speed, state->job.rot);
+
+	/* Auswahl der naechsten Stationen nur, wenn gesetzt */
+	if (get_int(KNEAREST) > 0) {
+		fprintf(fh, " | KNEAREST=%i | KMAXR=%i", get_int(KNEAREST),
+		    get_int(KMAXR));
+	}
+
+	/* Interpolation in Delaunay-Dreiecken nur, wenn gesetzt */
+	if (get_int(DELAUNAY) != 0) {
+		fprintf(fh, " | DELAUNAY=%i", get_int(DELAUNAY));
+	}
+
+	/* Integrationsverfahren nur, wenn nicht Euler */
+	if (get_int(INTEGRATOR) != 0) {
+		fprintf(fh, " | INTEGRATOR=%i", get_int(INTEGRATOR));
+	}
+
+	/* Schrittweitensteuerung nur, wenn gesetzt */
+	if (get_float(TOL) > 0.0) {
+		fprintf(fh, " | TOL=%6.4f", get_float(TOL));
+	}
 
-	fprintf(fh, "SPEED=%4.2f | ROT=%5.2f\n\n",
-	    get_float(SPEED), get_float(ROT));
+	/* Integration im Raum der Einheitsvektoren nur, wenn gesetzt */
+	if (get_int(VECTOR) != 0) {
+		fprintf(fh, " | VECTOR=%i", get_int(VECTOR));
+	}
+	fprintf(fh, "\n\n");
 
 	fprintf(fh, "Trajektorienpunkte: %i\n\n", (state->point));
 
@@ -1515,9 +6802,212 @@ print_output_file(const struct state* state)
 
 	/* Datei schliessen */
 	fclose(fh);
+
+	/* Die Kandidatenliste gibt es nur bei Stationsmeldungen */
+	if (wind_source == &station_source) {
+		printf("%s: %i points, candidate list rebuilt %i times in %i "
+		    "lookups\n", filename, state->point, 
+		    state->rebuild_count, state->lookup_count);
+	}
+	else {
+		printf("%s: %i points\n", filename, state->point);
+	}
+
+	/* Aufwand der Schrittweitensteuerung */
+	if (get_float(TOL) > 0.0) {
+		printf("%s: %i adaptive steps, %i rejected\n", filename, 
+		    state->step_count, state->reject_count);
+	}
+
 	free(filename);
 }
 
+/*
+ * Entpacken der komprimierten Tagesdatei name (.gz mit USE_ZLIB, .zst mit
+ * USE_ZSTD) in einen Puffer, der beim schrittweisen Entpacken nach Bedarf
+ * verdoppelt wird.
+ *
+ * Rueckgabewert ist
+ *    der (mit malloc angelegte) Puffer, size die Anzahl der Bytes darin
+ *    NULL, wenn name keine unterstuetzte komprimierte Datei ist
+ */
+char*
+read_compressed(const char* name, long* size)
+{
+	const char* suffix;
+	char*  buffer;
+#if defined(USE_ZLIB) || defined(USE_ZSTD)
+	long   max;
+#endif
+#ifdef USE_ZLIB
+	gzFile gz;
+	int    n;
+#endif
+#ifdef USE_ZSTD
+	ZSTD_DStream*  stream;
+	ZSTD_inBuffer  in;
+	ZSTD_outBuffer out;
+	FILE*  fh;
+	char*  chunk;
+	size_t ret;
+#endif
+
+	buffer = NULL;
+	*size = 0;
+
+	if ((suffix = strrchr(name, '.')) == NULL)
+		return NULL;
+
+#ifdef USE_ZLIB
+	/* gzip */
+	if (strcmp(suffix, ".gz") == 0) {
+		if (!(gz = gzopen(name, "rb"))) {
+			printf("Couldn't open file %s!\n", name);
+			exit(1);
+		}
+
+		max = 1 << 18;
+		buffer = malloc(max);
+
+		while ((n = gzread(gz, buffer + *size, max - *size)) > 0) {
+			*size += n;
+
+			/* Wenn Puffer voll ist */
+			if (*size == max) {
+				max *= 2;
+				buffer = realloc(buffer, max);
+			}
+		}
+
+		/* Auch eine abgeschnittene Datei (Z_BUF_ERROR) */
+		gzerror(gz, &n);
+
+		if (n != Z_OK) {
+			printf("Couldn't decompress file %s!\n", name);
+			exit(1);
+		}
+		gzclose(gz);
+	}
+#endif
+
+#ifdef USE_ZSTD
+	/* Zstandard */
+	if (strcmp(suffix, ".zst") == 0) {
+		if (!(fh = fopen(name, "rb"))) {
+			printf("Couldn't open file %s!\n", name);
+			exit(1);
+		}
+
+		stream = ZSTD_createDStream();
+		ZSTD_initDStream(stream);
+		chunk = malloc(ZSTD_DStreamInSize());
+		max = 1 << 18;
+		buffer = malloc(max);
+		ret = 0;
+
+		while ((in.size = fread(chunk, 1, ZSTD_DStreamInSize(), 
+		    fh)) > 0) {
+			in.src = chunk;
+			in.pos = 0;
+
+			/* 
+			 * Entpacken, bis die gelesenen Daten verbraucht sind
+			 * und der Ausgabepuffer nicht mehr voll wird
+			 */
+			do {
+				if (max - *size < (long)ZSTD_DStreamOutSize()) {
+					max *= 2;
+					buffer = realloc(buffer, max);
+				}
+
+				out.dst = buffer + *size;
+				out.size = max - *size;
+				out.pos = 0;
+
+				ret = ZSTD_decompressStream(stream, &out, &in);
+
+				if (ZSTD_isError(ret)) {
+					printf("Couldn't decompress file %s!\n",
+					    name);
+					exit(1);
+				}
+				*size += out.pos;
+			} while ((in.pos < in.size) || (out.pos == out.size));
+		}
+
+		/* Wenn die Datei mitten in einem Frame endet */
+		if (ret != 0) {
+			printf("Couldn't decompress file %s!\n", name);
+			exit(1);
+		}
+
+		free(chunk);
+		ZSTD_freeDStream(stream);
+		fclose(fh);
+	}
+#endif
+
+	return buffer;
+}
+
+/*
+ * Einlesen der Winddaten eines Tages (Tage seit dem 01.01.1970) aus dem 
+ * Winddatenarchiv bzw. aus der Tagesdatei in METEO in die Zeitfolge
+ * archive->timeline. Fehlt die Tagesdatei, wird eine vorhandene 
+ * komprimierte Variante gelesen.
+ */
+void
+read_day(struct archive* archive, int day)
+{
+	static const char* suffix[] = {
+#ifdef USE_ZLIB
+		".gz",
+#endif
+#ifdef USE_ZSTD
+		".zst",
+#endif
+		NULL
+	};
+	char name[MAXLINE];
+	int  i, n;
+
+	/* Tag aus dem Winddatenarchiv uebernehmen */
+	if (archive->pack != NULL) {
+		read_packed_day(archive, day);
+		return;
+	}
+
+	/* 
+	 * Namensgenerierung der einzulesenden Winddatendatei (mit Platz 
+	 * fuer die Endung einer komprimierten Variante)
+	 */
+	if (generate_input_filename(day, name, MAXLINE - 4) >= MAXLINE - 4) {
+		printf("Linebuffer too small!\n");
+		exit(1);
+	}
+
+	/* Erste vorhandene Variante der Tagesdatei */
+	if (access(name, F_OK) != 0) {
+		n = strlen(name);
+
+		for (i = 0; suffix[i] != NULL; i++) {
+			strcpy(name + n, suffix[i]);
+			if (access(name, F_OK) == 0)
+				break;
+		}
+
+		/* Fehlermeldung in read_file() mit dem unkomprimierten Namen */
+		if (suffix[i] == NULL)
+			name[n] = '\0';
+	}
+
+	/*Ausgabe des generierten Dateinamens */
+	printf("%s\n", name);
+
+	/* Daten aus der Datei einlesen */
+	read_file(archive, name, day);
+}
+
 /*
  * Initialisieren und einlesen der Standardwerte und der gesetzten
  * Programmargumente aus der Programmumgebung
@@ -1558,246 +7048,472 @@ read_env(struct param *param)
 }
 
 /*
- * Einlesen der Winddaten
+ * Einlesen der Winddaten der Tagesdatei name zum Tag day (Tage seit dem
+ * 01.01.1970) in die Zeitfolge archive->timeline. Die Datei wird als 
+ * Ganzes eingeblendet (USE_MMAP), in einem Block eingelesen bzw. entpackt
+ * (siehe read_compressed()) und ohne Kopieren der Zeilen direkt im Puffer
+ * zerlegt (siehe scan_int()). Jeder Datenblock wird zunaechst dicht 
+ * (Richtung, Geschwindigkeit und p fuer alle Stationen) eingelesen und am
+ * Blockende mit store_field() als Liste der Stationen mit Daten 
+ * gespeichert. Die Windmeldungen werden unkorrigiert uebernommen (siehe
+ * correct_wind()). Bei tageweisem Nachladen muessen alle Datenbloecke zum
+ * Tag day gehoeren.
  */
-struct winddata*
-read_file(struct state* state, char* name)
+void
+read_file(struct archive* archive, char* name, int day)
 {
-	char  line[MAXLINE];
-	int   i, c, A, B, C;
-	char* tok;
-	FILE* fh;
-	struct winddata* winddata_pnt;
-	double wind_speed, wind_direction;
+	const char* pos;  /* aktuelle Position im Puffer */
+	const char* eol;  /* Ende der aktuellen Zeile */
+	const char* end;  /* Ende des Puffers */
+	char*  buffer;
+	long   size;
+	int    i, A, B, C;
+	int    hour;   /* Index des aktuellen Datenblocks in der Zeitfolge */
+	int    block;  /* 1, wenn der aktuelle Datenblock Winddaten enthaelt */
+	int    mapped; /* 1, wenn der Puffer eingeblendet ist */
+	FILE*  fh;
+	struct date time;
+	struct field* field;
+	int*   direction;
+	int*   speed;
+	char*  p;
+
+	hour = -1;
+	block = 0;
+	field = archive->timeline.field;
+	direction = calloc(2 * archive->station_max + 1, sizeof(int));
+	speed = direction + archive->station_max;
+	p = calloc(archive->station_max + 1, 1);
+
+	/* Komprimierte Tagesdatei im Speicher entpacken */
+	mapped = 0;
+	buffer = read_compressed(name, &size);
 
-	winddata_pnt = new_winddata();
-	
 	/* Ueberpruefen, ob Datei existiert */
-	if (!(fh = fopen(name, "r"))) {
+	if ((buffer == NULL) && !(fh = fopen(name, "rb"))) {
 		printf("Couldn't open file %s!\n", name);
 		exit(1);
 	}
 
-	/* Naechsten Zeitangabeblock suchen */
-	while (1) {
-
-		i = -1;
+	if (buffer == NULL) {
+		fseek(fh, 0, SEEK_END);
+		size = ftell(fh);
 
-		/* Einlesen einer Zeile */
-		do {
+		if (size > 0) {
+#ifdef USE_MMAP
+			buffer = mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+			    fileno(fh), 0);
 
-			c = fgetc(fh);
-
-                        /* Wenn Dateiende */
-			if (c == EOF) 
-				break; 
-
-			line[++i] = (char)c;
-
-			/* Wenn Datenbuffer zu klein ist */
-			if (i == (MAXLINE - 1)) {
-				printf("Linebuffer too small!\n");
+			if (buffer == MAP_FAILED) {
+				printf("Couldn't map file %s!\n", name);
 				exit(1);
 			}
+			mapped = 1;
+#else
+			buffer = malloc(size);
+			rewind(fh);
 
-			/* Carriage Return ignorieren */ 
-			if (line[i] == '\r') {
-				i--;
+			if (fread(buffer, 1, size, fh) != (size_t)size) {
+				printf("Couldn't read file %s!\n", name);
+				exit(1);
 			}
+#endif
+		}
+		fclose(fh);
+	}
 
-		} while (line[i] != '\n');
+	end = buffer + size;
 
-		/* Wenn Dateiende */
-		if (c == EOF) 
-			break; 
+	/* Zeilenweise Zerlegen des Puffers */
+	for (pos = buffer; pos < end; pos = eol + 1) {
 
-		line[++i] = '\0';
+		/* Zeilenende suchen (die letzte Zeile darf ohne enden) */
+		if ((eol = memchr(pos, '\n', end - pos)) == NULL) {
+			eol = end;
+		}
 
-		/* Wenn eingelesene Zeile nicht Winddatenzeile ist */
-		if (line[0] != ' ') {
-		
-			if (line[0] != '*') {
-				/* Zeichenkette terminieren */
-
-				if (get_int(TRACE) < 0) { 
-					winddata_pnt->next = new_winddata();
-					winddata_pnt->next->prev = 
-					    winddata_pnt;
-					winddata_pnt = winddata_pnt->next;
-				}
-				else {
-					winddata_pnt->prev = new_winddata();
-					winddata_pnt->prev->next = 
-					    winddata_pnt;
-					winddata_pnt = winddata_pnt->prev;
-				}
+		/* Blockende (*ENDBLOCK) ignorieren */
+		if (*pos == '*') 
+			continue;
 
-				/* Zuweisen der Zeitangabe */
-				if ((tok = strtok(line, " ")) == NULL) {
-					printf("Syntax error in wind data\n");
-					exit(1);
-				}
-				
-				for (i = 0; i < 4; i++) {
-					switch(i) {
-					case 0:
-						winddata_pnt->time.year = 
-						    atoi(tok);
-						break;
-					case 1:
-						winddata_pnt->time.month = 
-						    atoi(tok);
-						break;
-					case 2:
-						winddata_pnt->time.day = 
-						    atoi(tok);
-						break;
-					case 3:
-						winddata_pnt->time.hour = 
-						    atoi(tok);
-						break;
-					}
-					if (((tok = strtok(NULL, " ")) == 
-						NULL) && (i < 3)) {
-					printf("Syntax error in winddata\n");
-						exit(1);
-					}
-				}
+		/* Wenn Zeile nicht Winddatenzeile ist -> Zeitangabe */
+		if (*pos != ' ') {
+
+			/* Speichern des vorherigen Datenblocks */
+			if (block) {
+				store_field(&field[hour], archive->station_max,
+				    direction, speed, p);
 			}
-		}
-		else {
-			if (winddata_pnt->wind == NULL) {
-				winddata_pnt->wind = 
-				    calloc(state->station_max, 
-					sizeof(struct wind));
-				for (i = 0; i < state->station_max; i++) {
-					winddata_pnt->wind[i].u = 0;
-					winddata_pnt->wind[i].v = 0;
-					winddata_pnt->wind[i].p = 0;
-				}
+
+			/* Zuweisen der Zeitangabe */
+			if (!scan_int(&pos, eol, &time.year) ||
+			    !scan_int(&pos, eol, &time.month) ||
+			    !scan_int(&pos, eol, &time.day) ||
+			    !scan_int(&pos, eol, &time.hour)) {
+				printf("Syntax error in winddata\n");
+				exit(1);
 			}
-			
-			/* Winddaten in aktuelles Element einlesen und
-			   mit Stationsliste vergleichen */
-			/* Einlesen der Winddaten */
-			if ((tok = strtok(line, " ")) == NULL) {
-				printf("Syntax error in wind data\n");
+
+			/* 
+			 * Stunde des Datenblocks in der Zeitfolge (die 
+			 * Datenbloecke sind zeitlich rueckwaerts geordnet)
+			 */
+			hour = date_to_hours(&time) - archive->timeline.first;
+
+			if ((hour < 0) || 
+			    (hour >= archive->timeline.hour_max) ||
+			    ((archive->cache.ref != NULL) &&
+			     (hour / 24 != day - 
+			      archive->timeline.first / 24))) {
+				printf("Unexpected time %04i-%02i-%02i %02i in "
+				    "file %s!\n", time.year, time.month, 
+				    time.day, time.hour, name);
 				exit(1);
 			}
-			
-			for (i = 0; i < 3; i++) {
-				switch(i) {
-				case 0:
-					A = atoi(tok);
-					break;
-				case 1:
-					B = atoi(tok);
-					break;
-				case 2:
-					C = atoi(tok);
-					break;
-				}
-				if (((tok = strtok(NULL, " ")) == NULL) && 
-				    (i < 2)) {
-					printf("Syntax error in wind data\n");
-					exit(1);
-				}
+
+			/* 
+			 * Wenn zu dieser Stunde schon ein Windfeld existiert,
+			 * wird es ergaenzt
+			 */
+			block = (field[hour].report != NULL);
+
+			for (i = 0; block && (i < field[hour].n); i++) {
+				A = field[hour].report[i].s;
+				direction[A] = field[hour].report[i].direction;
+				speed[A] = field[hour].report[i].speed;
+				p[A] = 1;
 			}
-			
-			for (i = 0; i < state->station_max; i++) {
-				
-				/* 
-				 * Wenn Stationsnummer in der Stationsliste 
-				 * enhalten ist -> Winddaten speichern
-				 */
-				if (state->station_list[i].nr == A) {
-					wind_direction = B;
-					wind_speed = C;
-					
-					/* 
-					 * Wenn Windgeschwindigkeiten in 
-					 * Knoten angegeben sind -> muss in 
-					 * m\s umgerechnet werden
-					 */
-					if (state->station_list[i].unit 
-					    == 2) {
-						wind_speed = wind_speed * 
-						    MILE / 3.6;
-					}
-					
-					/* 
-					 * Anpassung der Bodenwindge-
-					 * schwindigkeit auf mittlere 
-					 * Transportgeschwindigkeit in der 
-					 * Mischungsschicht durch Windge-
-					 * schwindigkeitsfaktor
-					 */
-					wind_speed = wind_speed * 
-					    get_float(SPEED);
-					
-					/* 
-					 * Hier wird (wenn rotation_flag 
-					 * == 1) die Drehung des Bodenwindes 
-					 * dynamisches auf den Laengengrad 
-					 * angepasst. Winddrehung is 
-					 * abhaengig vom Laengengrad der 
-					 * Wetterstation 
-					 * 
-					 * -> Umrechnen der Winddrehung der 
-					 * Startposition (Startparameter) auf 
-					 * Rotation an der Wetterstations-
-					 * position
-					 */
-					
-					/* 
-					 * Windrichtungskorrektur 
-					 */
-					wind_direction += get_float(ROT);
-
-					/* Grad -> RAD */
-					wind_direction = 
-					    deg2rad(wind_direction);
-					
-					/* 
-					 * Speichern der eingelesenen 
-					 * korrigierten Werte in der 
-					 * Winddatenstruktur 
-					 */
-					winddata_pnt->wind[i].u = 
-					    wind_speed * sin(wind_direction);
-					
-					winddata_pnt->wind[i].v = 
-					    wind_speed * cos(wind_direction);
-					
-					winddata_pnt->wind[i].p = 
-					    1;
-				}
+
+			free(field[hour].report);
+			field[hour].report = NULL;
+			continue;
+		}
+
+		/* Wenn Winddaten vor dem ersten Blockanfang */
+		if (hour < 0) {
+			printf("Syntax error in wind data\n");
+			exit(1);
+		}
+
+		block = 1;
+
+		/* 
+		 * Einlesen der Winddaten (Stationsnummer, Windrichtung, 
+		 * Windgeschwindigkeit, eine weitere Spalte wird ignoriert)
+		 */
+		if (!scan_int(&pos, eol, &A) || !scan_int(&pos, eol, &B) ||
+		    !scan_int(&pos, eol, &C)) {
+			printf("Syntax error in wind data\n");
+			exit(1);
+		}
+
+		/* 
+		 * Wenn Stationsnummer in der Stationsliste enhalten ist -> 
+		 * Windmeldung speichern (fuer alle Stationen mit dieser 
+		 * Nummer), sonst Zeile zaehlen
+		 */
+		i = find_station(archive, A);
+
+		if (i < 0) {
+			archive->unknown_count += 1;
+		}
+
+		for (; i >= 0; i = archive->catalog.same[i]) {
+			direction[i] = B;
+			speed[i] = C;
+			p[i] = 1;
+		}
+	}
+
+	/* Speichern des letzten Datenblocks */
+	if (block) {
+		store_field(&field[hour], archive->station_max, direction,
+		    speed, p);
+	}
+
+	if (mapped) {
+#ifdef USE_MMAP
+		munmap(buffer, size);
+#endif
+	}
+	else {
+		free(buffer);
+	}
+
+	free(direction);
+	free(p);
+
+	/* Wenn Datei keine Datenbloecke enthaelt */
+	if (hour < 0) {
+		printf("No wind data in file %s!\n", name);
+		exit(1);
+	}
+}
+
+/*
+ * Lesen eines Gitter-Windfelds aus GRIDCACHE. Passt die Datei nicht zum 
+ * Schluessel (anderes Format, unvollstaendige Datei), wird das Gitter neu
+ * berechnet und die Datei ersetzt.
+ *
+ * Rueckgabewert ist
+ *    das gelesene Gitter-Windfeld
+ *    NULL, wenn kein passendes Gitter in GRIDCACHE vorliegt
+ */
+struct grid*
+read_grid(unsigned long long key)
+{
+	const struct grid_header* header;
+	struct grid* grid;
+	char         name[MAXLINE];
+	long         count;
+	FILE*        fh;
+
+	if (strlen(get_string(GRIDCACHE)) == 0)
+		return NULL;
+
+	generate_grid_filename(key, name, MAXLINE);
+
+	if (!(fh = fopen(name, "rb")))
+		return NULL;
+
+	grid = calloc(1, sizeof(struct grid));
+	grid->key = key;
+
+	fseek(fh, 0, SEEK_END);
+	grid->size = ftell(fh);
+
+	if (grid->size < (long)sizeof(struct grid_header)) {
+		fclose(fh);
+		free(grid);
+		return NULL;
+	}
+
+#ifdef USE_MMAP
+	grid->data = mmap(NULL, grid->size, PROT_READ, MAP_SHARED, 
+	    fileno(fh), 0);
+
+	if (grid->data == MAP_FAILED) {
+		printf("Couldn't map file %s!\n", name);
+		exit(1);
+	}
+	grid->mapped = 1;
+#else
+	grid->data = malloc(grid->size);
+	rewind(fh);
+
+	if (fread(grid->data, 1, grid->size, fh) != (size_t)grid->size) {
+		printf("Couldn't read file %s!\n", name);
+		exit(1);
+	}
+#endif
+	fclose(fh);
+
+	header = (const struct grid_header*)grid->data;
+	count = (long)header->lo_max * header->la_max;
+
+	if ((strncmp(header->magic, GRIDMAGIC, sizeof(header->magic)) != 0) ||
+	    (header->version != GRIDVER) || (header->key != key) ||
+	    (header->lo_max <= 0) || (header->la_max <= 0) ||
+	    (grid->size != (long)sizeof(struct grid_header) + 
+	     count * (long)(2 * sizeof(float) + 1))) {
+		free_grid(grid);
+		return NULL;
+	}
+
+	grid->header = header;
+	grid->u = (const float*)(grid->data + sizeof(struct grid_header));
+	grid->v = grid->u + count;
+	grid->mask = (const unsigned char*)(grid->v + count);
+
+	return grid;
+}
+
+/*
+ * Einlesen der Auftragsdatei (JOBS). Ist keine Auftragsdatei angegeben,
+ * wird genau ein Auftrag aus den Startparametern erzeugt.
+ *
+ * Rueckgabewert ist das Feld der Auftraege, job_max die Anzahl der Auftraege
+ */
+struct job*
+read_jobs(int* job_max)
+{
+	char        line[MAXLINE];
+	int         i, size;
+	char*       tok;
+	FILE*       fh;
+	struct job* job;
+
+	/* Wenn keine Auftragsdatei angegeben ist */
+	if (strlen(get_string(JOBS)) == 0) {
+		job = calloc(1, sizeof(struct job));
+		job->lo = get_float(LO);
+		job->la = get_float(LA);
+		job->time.year = get_int(YYYY);
+		job->time.month = get_int(MM);
+		job->time.day = get_int(DD);
+		job->time.hour = get_int(HH);
+		job->trace = get_int(TRACE);
+		job->speed = get_float(SPEED);
+		job->rot = get_float(ROT);
+		job->maxr = get_int(MAXR);
+		job->minr = get_int(MINR);
+		*job_max = 1;
+		return job;
+	}
+
+	/* Ueberpruefen, ob Datei existiert */
+	if (!(fh = fopen(get_string(JOBS), "r"))) {
+		printf("Couldn't open file %s!\n", get_string(JOBS));
+		exit(1);
+	}
+
+	size = 64;
+	job = calloc(size, sizeof(struct job));
+	*job_max = 0;
+
+	while (fgets(line, MAXLINE, fh)) {
+
+		/* Leerzeilen und Kommentarzeilen ueberspringen */
+		if ((tok = strtok(line, " \t\r\n")) == NULL || tok[0] == '#')
+			continue;
+
+		/* Wenn Auftragsfeld zu klein ist */
+		if (*job_max == size) {
+			size *= 2;
+			job = realloc(job, size * sizeof(struct job));
+		}
+
+		for (i = 0; i < 7; i++) {
+			if (tok == NULL) {
+				printf("Syntax error in file %s\n", 
+				    get_string(JOBS));
+				exit(1);
+			}
+
+			switch(i) {
+			case 0:
+				job[*job_max].lo = atof(tok);
+				break;
+			case 1:
+				job[*job_max].la = atof(tok);
+				break;
+			case 2:
+				job[*job_max].time.year = atoi(tok);
+				break;
+			case 3:
+				job[*job_max].time.month = atoi(tok);
+				break;
+			case 4:
+				job[*job_max].time.day = atoi(tok);
+				break;
+			case 5:
+				job[*job_max].time.hour = atoi(tok);
+				break;
+			case 6:
+				job[*job_max].trace = atoi(tok);
+				break;
 			}
+			tok = strtok(NULL, " \t\r\n");
 		}
+
+		job[*job_max].speed = get_float(SPEED);
+		job[*job_max].rot = get_float(ROT);
+		job[*job_max].maxr = get_int(MAXR);
+		job[*job_max].minr = get_int(MINR);
+		*job_max += 1;
 	}
-	
+
+	/* Datei schliessen */
 	fclose(fh);
-	while (winddata_pnt->prev != NULL) { 
-		winddata_pnt = winddata_pnt->prev;
+
+	if (*job_max == 0) {
+		printf("No jobs in file %s!\n", get_string(JOBS));
+		exit(1);
+	}
+
+	return job;
+}
+
+/*
+ * Uebernehmen der Stunden-Windfelder eines Tages (Tage seit dem 01.01.1970)
+ * aus dem eingeblendeten Winddatenarchiv in die Zeitfolge
+ * archive->timeline. Die Windfelder werden ohne Kopie direkt im Archiv
+ * verwendet, es werden nur die Stationsindizes geprueft.
+ */
+void
+read_packed_day(struct archive* archive, int day)
+{
+	const struct pack_header* header;
+	const struct pack_hour*   hour;
+	struct timeline*          timeline = &archive->timeline;
+	struct field*             field;
+	struct date               time;
+	int   i, j, h;
+
+	header = (const struct pack_header*)archive->pack;
+	hour = (const struct pack_hour*)(archive->pack + header->hour_offset);
+	h = day * 24 - header->first;
+
+	/* Wenn der Tag nicht im Archiv enthalten ist */
+	if ((h < 0) || (h + 24 > header->hour_max) ||
+	    (hour[h].kind == PACK_MISSING)) {
+		hours_to_date(day * 24, &time);
+		printf("No wind data for %04i-%02i-%02i in archive %s!\n",
+		    time.year, time.month, time.day, get_string(ARCHIVE));
+		exit(1);
 	}
 
-	return winddata_pnt;
+	for (i = 0; i < 24; i++, h++) {
+
+		if (hour[h].kind != PACK_FIELD)
+			continue;
+
+		if ((hour[h].count < 0) || (hour[h].offset < 0) ||
+		    (hour[h].offset % (long)sizeof(int) != 0) ||
+		    (hour[h].offset + hour[h].count *
+		     (long)sizeof(struct report) > archive->pack_size)) {
+			printf("Archive %s: wrong format!\n",
+			    get_string(ARCHIVE));
+			exit(1);
+		}
+
+		/* Index der Stunde in der Zeitfolge */
+		field = &timeline->field[day * 24 - timeline->first + i];
+		field->n = hour[h].count;
+		field->report = (struct report*)(archive->pack + 
+		    hour[h].offset);
+		timeline->mapped[day * 24 - timeline->first + i] = 1;
+
+		/* Stationsindizes muessen aufsteigend und gueltig sein */
+		for (j = 0; j < field->n; j++) {
+			if ((field->report[j].s < 0) ||
+			    (field->report[j].s >= archive->station_max) ||
+			    ((j > 0) &&
+			     (field->report[j].s <= field->report[j - 1].s))) {
+				printf("Archive %s: wrong format!\n",
+				    get_string(ARCHIVE));
+				exit(1);
+			}
+		}
+	}
 }
 
 /*
  * Speichern der Stationsinformationen aus der Stationsinformations-
- * datei in der internen Datenstruktur state->station_list
+ * datei in der internen Datenstruktur archive->station_list
  */
 void
-read_station_list(struct state* state)
+read_station_list(struct archive* archive)
 {
-	int    i, j;
+	int    i, j, size;
 	char   line[MAXLINE];
 	double la_tmp, lo_tmp;
 	FILE*  fh;
 	char*  tok;
 
 	la_tmp = lo_tmp = 0.0;
+	size = 1024;
+	archive->station_list = calloc(size, sizeof(struct station));
 
 	/* Ueberpruefen, ob Datei existiert */
 	if (!(fh = fopen(get_string(STATION), "r"))) {
@@ -1807,6 +7523,13 @@ read_station_list(struct state* state)
 
 	/* Einlesen der benoetigten Stationsparameter */
 	for (i = 0; fgets(line, MAXLINE, fh); i++) {
+
+		/* Wenn Stationsliste zu klein ist */
+		if (i == size) {
+			size *= 2;
+			archive->station_list = realloc(archive->station_list,
+			    size * sizeof(struct station));
+		}
 		
 		if ((tok = strtok(line, " ")) == NULL) {
 			printf("Syntax error in file %s\n", 
@@ -1818,7 +7541,7 @@ read_station_list(struct state* state)
 			/*XXX Testen, ob parameter ein integer ist */
 			switch(j) {
 			case 0:
-				state->station_list[i].nr = 
+				archive->station_list[i].nr = 
 				    atoi(tok);
 				break;
 			case 1:
@@ -1828,24 +7551,26 @@ read_station_list(struct state* state)
 				lo_tmp = atoi(tok);
 				break;
 			case 4:
+				archive->station_list[i].unit = atoi(tok);
+
 				switch(get_int(DATAUNIT)) {
 				case 0:
-					state->station_list[i].unit = 
-					    2;
+					archive->station_list[i].knots = 
+					    1;
 					break;
 					
 				case 1:
-					state->station_list[i].unit = 
-					    1;
+					archive->station_list[i].knots = 
+					    0;
 					break;
 					
 				case 2:
-					state->station_list[i].unit = 
-					    atoi(tok);
+					archive->station_list[i].knots = 
+					    (atoi(tok) == 2);
 					break;
 				default:
-					state->station_list[i].unit = 
-					    2;
+					archive->station_list[i].knots = 
+					    1;
 					break;
 				}
 				break;
@@ -1863,8 +7588,8 @@ read_station_list(struct state* state)
 		 * wurde -> range checking 
 		 */
 		if (get_int(DATAUNIT) == 2) {
-			if ((state->station_list[i].unit < 1) ||
-			    (state->station_list[i].unit > 2)) {
+			if ((archive->station_list[i].unit < 1) ||
+			    (archive->station_list[i].unit > 2)) {
 				printf("Unknown value for unit!\n");
 				exit(1);
 			}
@@ -1880,157 +7605,781 @@ read_station_list(struct state* state)
 		 * Umrechnen der geographischen Koordinaten in
 		 * kartesische Koordinaten 
 		 */
-		state->station_list[i].X[0] = cos(la_tmp) * cos(lo_tmp);
-		state->station_list[i].X[1] = cos(la_tmp) * sin(lo_tmp);
-		state->station_list[i].X[2] = sin(la_tmp);
+		archive->station_list[i].X[0] = cos(la_tmp) * cos(lo_tmp);
+		archive->station_list[i].X[1] = cos(la_tmp) * sin(lo_tmp);
+		archive->station_list[i].X[2] = sin(la_tmp);
 	}
 
 	/* Datei schliessen */
 	fclose(fh);
+
+	archive->station_max = i;
+
+	/* 
+	 * Aufbauen des Stationskatalogs und des raeumlichen Index ueber die
+	 * Stationsliste 
+	 */
+	init_station_catalog(archive);
+	init_station_index(archive);
+}
+
+/* 
+ * Einlesen aller von den Auftraegen benoetigten Tagesdatensaetze. Jeder
+ * Tagesdatensatz wird nur einmal eingelesen, die Stunden-Windfelder werden
+ * in der Zeitfolge archive->timeline gespeichert, die vom ersten bis zum 
+ * letzten benoetigten Tag reicht.
+ */
+void
+read_wind_data(struct archive* archive, const struct job* job, int job_max)
+{
+	struct day_cache* cache = &archive->cache;
+	int               i, j, day_max, size;
+	int*              day;
+
+	/* Erstellen einer Liste von benoetigten Tagesdatensaetzen */
+	size = 16;
+	day = calloc(size, sizeof(int));
+	day_max = 0;
+
+	for (i = 0; i < job_max; i++) {
+		collect_days(&job[i], &day, &day_max, &size);
+	}
+
+	/* Zeitlich aufsteigend sortieren */
+	qsort(day, day_max, sizeof(int), compare_int);
+
+	/* 
+	 * Bei tageweisem Nachladen zaehlen, wie viele Auftraege jeden Tag 
+	 * benoetigen (collect_days() traegt jeden Tag eines Auftrags einmal
+	 * ein, siehe retire_days())
+	 */
+	if ((get_int(WINDOW) > 0) || (strlen(get_string(SERIES)) > 0)) {
+		cache->day_max = day[day_max - 1] - day[0] + 1;
+		cache->ref = calloc(3 * cache->day_max, sizeof(int));
+		cache->used = cache->ref + cache->day_max;
+		cache->needed = cache->ref + 2 * cache->day_max;
+		for (i = 0; i < day_max; i++) {
+			cache->needed[day[i] - day[0]] += 1;
+		}
+	}
+
+	/* Doppelte Tage entfernen */
+	for (i = j = 0; i < day_max; i++) {
+		if ((j == 0) || (day[j - 1] != day[i])) {
+			day[j] = day[i];
+			j++;
+		}
+	}
+	day_max = j;
+
+	/* Zeitfolge vom ersten bis zum letzten Tag anlegen */
+	archive->timeline.first = day[0] * 24;
+	archive->timeline.hour_max = (day[day_max - 1] - day[0] + 1) * 24;
+	archive->timeline.field = calloc(archive->timeline.hour_max, 
+	    sizeof(struct field));
+	archive->timeline.mapped = calloc(archive->timeline.hour_max, 1);
+
+	/* 
+	 * Bei tageweisem Nachladen werden die Tage erst waehrend der 
+	 * Trajektorienberechnung eingelesen (siehe acquire_day())
+	 */
+	if (cache->ref != NULL) {
+		cache->loaded = calloc(3 * cache->day_max, 1);
+		cache->counted = cache->loaded + cache->day_max;
+		cache->loading = cache->counted + cache->day_max;
+
+		cache->request = -1;
+		for (i = 0; i < 2; i++) {
+			drop_prefetch(&cache->slot[i]);
+		}
+
+#ifdef USE_PTHREAD
+		pthread_mutex_init(&cache->lock, NULL);
+
+		/* Vorauslade-Thread starten */
+		if (get_int(PREFETCH) != 0) {
+			pthread_cond_init(&cache->wake, NULL);
+			pthread_cond_init(&cache->done, NULL);
+			if (pthread_create(&cache->thread, NULL, 
+			    prefetch_main, archive) != 0) {
+				printf("Couldn't create thread!\n");
+				exit(1);
+			}
+			cache->prefetch = 1;
+		}
+#endif
+
+		init_timeline(&archive->timeline, 0, 0);
+		free(day);
+		return;
+	}
+
+	/* Daten aller Tage (parallel) einlesen */
+	ingest_days(archive, day, day_max);
+
+	/* Winddatenzeilen unbekannter Stationen melden */
+	if (archive->unknown_count > 0) {
+		printf("%i wind records of stations not in %s ignored\n",
+		    archive->unknown_count, get_string(STATION));
+	}
+
+	/* Nachschlagetabellen fuer die Suche nach Windfeldern aufbauen */
+	init_timeline(&archive->timeline, 0, archive->timeline.hour_max);
+	
+	/* Speicher freigeben */
+	free(day);
+}
+
+/*
+ * Freigeben eines Tages der Zeitfolge (Tagesindex d in archive->timeline)
+ * durch eine Trajektorie. Der Tag bleibt eingelesen, bis er fuer einen 
+ * anderen Tag verworfen werden muss (siehe load_day()).
+ */
+void
+release_day(struct archive* archive, int d)
+{
+	struct day_cache* cache = &archive->cache;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	cache->ref[d] -= 1;
+	cache->clock += 1;
+	cache->used[d] = cache->clock;
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+}
+
+/*
+ * Freigeben eines Gitter-Windfelds durch eine Trajektorie. Von den 
+ * unbenutzten Gittern bleiben die GRIDKEEP zuletzt benutzten im Speicher.
+ */
+void
+release_grid(struct archive* archive, struct grid* grid)
+{
+	struct grid_cache* cache = &archive->grids;
+	struct grid**      link;
+	struct grid**      last = NULL;
+
+	if (grid == NULL)
+		return;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	grid->ref -= 1;
+	if (grid->ref == 0)
+		cache->idle_count += 1;
+
+	/* Austragen des am laengsten unbenutzten Gitters */
+	grid = NULL;
+	if (cache->idle_count > GRIDKEEP) {
+		for (link = &cache->list; *link != NULL; 
+		    link = &(*link)->next) {
+			if ((*link)->ref == 0)
+				last = link;
+		}
+		grid = *last;
+		*last = grid->next;
+		cache->idle_count -= 1;
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+
+	if (grid != NULL)
+		free_grid(grid);
+}
+
+/*
+ * Freigeben einer von einer Trajektorie gehaltenen Delaunay-
+ * Triangulation (NULL: keine). Von den unbenutzten Triangulationen 
+ * bleiben die MESHKEEP zuletzt benutzten im Speicher.
+ */
+void
+release_mesh(struct archive* archive, struct mesh* mesh)
+{
+	struct mesh_cache* cache = &archive->meshes;
+	struct mesh**      link;
+	struct mesh**      last = NULL;
+
+	if (mesh == NULL)
+		return;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	mesh->ref -= 1;
+	if (mesh->ref == 0)
+		cache->idle_count += 1;
+
+	/* Austragen der am laengsten unbenutzten Triangulation */
+	mesh = NULL;
+	if (cache->idle_count > MESHKEEP) {
+		for (link = &cache->list; *link != NULL; 
+		    link = &(*link)->next) {
+			if ((*link)->ref == 0)
+				last = link;
+		}
+		mesh = *last;
+		*last = mesh->next;
+		cache->idle_count -= 1;
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+
+	if (mesh != NULL)
+		free_mesh(mesh);
+}
+
+/*
+ * Freigeben der von allen Auftraegen gemeinsam genutzten Eingabedaten
+ * ueber die Windquelle
+ */
+void
+reset_archive(struct archive* archive)
+{
+	wind_source->close(archive);
+}
+
+/* Freigeben der reservierten Speicherbereiche einer Gruppe */
+void
+reset_lockstep(struct lockstep* group)
+{
+	int i, k;
+
+	/* Die Stunden-Windfelder gehoeren clock */
+	for (i = 0; i < group->member_max; i++) {
+		for (k = 0; k < 2; k++) {
+			group->member[i].wind_current[k].wind = NULL;
+			group->member[i].slot[k] = NULL;
+		}
+		reset_state(&group->member[i]);
+	}
+	reset_state(&group->clock);
+
+	free(group->member);
+	free(group->offset);
+	free(group->x);
+	free(group->lane_n);
+	free(group->X[0]);
+	free(group->sum);
+	free(group->acc);
+}
+
+/*
+ * Freigeben der reservierten Speicherbereiche und schliessen der Sammeldatei
+ */
+void
+reset_state(struct state* state)
+{
+	/* Von der Trajektorie gehaltene Winddaten freigeben */
+	if (wind_source->end != NULL) {
+		wind_source->end(state);
+	}
+
+	free(state->lo);
+	free(state->la);
+	free(state->wind_current[0].wind);
+	free(state->wind_current[1].wind);
+	free(state->slot[0]);
+	free(state->slot[1]);
+	free(state->candidate);
+	free(state->nearest);
+	free(state->nearest_cos);
+	free(state->kernel.x);
+	free(state->kernel.w);
+	free(state->kernel.p1);
+}
+
+/*
+ * Austragen eines erledigten Auftrags aus dem Tagesbedarf bei tageweisem
+ * Nachladen. Tage, die kein unerledigter Auftrag mehr benoetigt und die 
+ * keine Trajektorie haelt, werden sofort verworfen, statt bis zum 
+ * Erreichen von WINDOW eingelesen zu bleiben.
+ */
+void
+retire_days(struct archive* archive, const struct job* job)
+{
+	struct day_cache* cache = &archive->cache;
+	int               i, d, day_max, size;
+	int*              day;
+
+	if (cache->ref == NULL)
+		return;
+
+	size = 16;
+	day = calloc(size, sizeof(int));
+	day_max = 0;
+
+	collect_days(job, &day, &day_max, &size);
+
+#ifdef USE_PTHREAD
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (i = 0; i < day_max; i++) {
+		d = day[i] - archive->timeline.first / 24;
+		cache->needed[d] -= 1;
+
+		if ((cache->needed[d] == 0) && (cache->ref[d] == 0) &&
+		    (cache->loaded[d] != 0)) {
+			free_day(archive, d);
+		}
+	}
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock(&cache->lock);
+#endif
+
+	free(day);
+}
+
+/* Berechnen und Ausgeben einer einzelnen Trajektorie (Auftrag) */
+void
+run_job(struct archive* archive, const struct job* job)
+{
+	struct state state;
+
+	/* 
+	 * Initialisieren der Datenstruktur zum Abbilden des 
+	 * programminternen Berechnungsstatus
+	 */
+	init_values(&state, archive, job);
+
+	/* Berechnen der Trajektorie */
+	calculate(&state);
+
+	/* Ausgeben der Trajektorie */
+	print_output_file(&state);
+
+	/* Reservierte Speicherbereiche wieder freigeben */
+	reset_state(&state);
+
+	/* Nicht mehr benoetigte Tage verwerfen */
+	retire_days(archive, job);
+}
+
+/*
+ * Bearbeiten aller Auftraege. Bei mehr als einem Thread werden die 
+ * Auftraege blockweise auf die Threads verteilt, die sich gegenseitig 
+ * noch nicht begonnene Auftraege abnehmen (siehe take_job()). Sind die 
+ * Auftraege fuer den Gleichschritt gruppiert (group, siehe group_jobs()),
+ * werden statt der Auftraege die Gruppen verteilt.
+ */
+void
+run_jobs(struct archive* archive, const struct job* job, int job_max,
+    const int* group, int group_max)
+{
+	int i, thread_max, unit_max;
+#ifdef USE_PTHREAD
+	struct pool    pool;
+	struct worker* worker;
+	pthread_t*     thread;
+#endif
+
+	thread_max = get_int(THREADS);
+	unit_max = (group != NULL) ? group_max : job_max;
+
+	/* Wenn Threadanzahl aus Prozessoranzahl bestimmt werden soll */
+	if (thread_max <= 0) {
+		thread_max = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (thread_max > unit_max) {
+		thread_max = unit_max;
+	}
+
+#ifdef USE_PTHREAD
+	if (thread_max > 1) {
+		pool.archive = archive;
+		pool.job = job;
+		pool.thread_max = thread_max;
+		pool.unit_max = unit_max;
+		pool.group = group;
+		pool.queue = calloc(thread_max, sizeof(struct queue));
+		worker = calloc(thread_max, sizeof(struct worker));
+		thread = calloc(thread_max, sizeof(pthread_t));
+
+		/* Blockweise Verteilung der Auftraege auf die Threads */
+		for (i = 0; i < thread_max; i++) {
+			pthread_mutex_init(&pool.queue[i].lock, NULL);
+			pool.queue[i].first = (int)((long)unit_max * i / 
+			    thread_max);
+			pool.queue[i].last = (int)((long)unit_max * (i + 1) / 
+			    thread_max);
+		}
+
+		for (i = 0; i < thread_max; i++) {
+			worker[i].pool = &pool;
+			worker[i].id = i;
+			if (pthread_create(&thread[i], NULL, worker_main,
+			    &worker[i]) != 0) {
+				printf("Couldn't create thread!\n");
+				exit(1);
+			}
+		}
+
+		for (i = 0; i < thread_max; i++) {
+			pthread_join(thread[i], NULL);
+		}
+
+		/* Erst wenn kein Thread mehr stehlen kann */
+		for (i = 0; i < thread_max; i++) {
+			pthread_mutex_destroy(&pool.queue[i].lock);
+		}
+
+		free(thread);
+		free(worker);
+		free(pool.queue);
+		return;
+	}
+#endif
+
+	for (i = 0; i < unit_max; i++) {
+		if (i + 1 < unit_max) {
+			prefetch_job(archive, 
+			    &job[(group != NULL) ? group[i + 1] : i + 1]);
+		}
+
+		if (group != NULL) {
+			run_lockstep(archive, &job[group[i]], 
+			    group[i + 1] - group[i]);
+		}
+		else {
+			run_job(archive, &job[i]);
+		}
+	}
+}
+
+/*
+ * Berechnen und Ausgeben der Trajektorien einer Gruppe im Gleichschritt 
+ * (Auftraege job[0] bis job[job_max - 1])
+ */
+void
+run_lockstep(struct archive* archive, const struct job* job, int job_max)
+{
+	struct lockstep group;
+	int             i;
+
+	init_lockstep(&group, archive, job, job_max);
+
+	/* Berechnen der Trajektorien */
+	calculate_lockstep(&group);
+
+	/* Ausgeben der Trajektorien */
+	for (i = 0; i < job_max; i++) {
+		print_output_file(&group.member[i]);
+	}
+
+	/* Reservierte Speicherbereiche wieder freigeben */
+	reset_lockstep(&group);
+
+	/* Nicht mehr benoetigte Tage verwerfen */
+	for (i = 0; i < job_max; i++) {
+		retire_days(archive, &job[i]);
+	}
+}
+
+/*
+ * Bilineares Interpolieren von u und v des Felds r einer Windgitterdatei 
+ * an der Position lo, la (Grad). Ueberdeckt das Gitter alle Laengengrade,
+ * wird ueber den Rand hinweg interpoliert.
+ *
+ * Rueckgabewert ist
+ *    0, wenn alle vier umgebenden Gitterpunkte Daten enthalten
+ *    1, sonst
+ */
+int
+sample_windgrid(const struct windgrid_header* header, int r, double lo, 
+    double la, double* u, double* v)
+{
+	const float* field_u;
+	const float* field_v;
+	double x, y;
+	int    i0, i1, j, n0, n1, global;
+
+	field_u = (const float*)(header + 1) + 
+	    2L * r * header->lo_max * header->la_max;
+	field_v = field_u + (long)header->lo_max * header->la_max;
+
+	global = (header->lo_max * header->lo_step >= 360.0);
+
+	x = fmod(lo - header->lo_first, 360.0);
+	if (x < 0)
+		x += 360.0;
+	x /= header->lo_step;
+	y = (la - header->la_first) / header->la_step;
+
+	i0 = (int)floor(x);
+	j = (int)floor(y);
+
+	if ((j < 0) || (j >= header->la_max - 1))
+		return 1;
+
+	if (global) {
+		i0 %= header->lo_max;
+		i1 = (i0 + 1) % header->lo_max;
+	}
+	else {
+		if (i0 >= header->lo_max - 1)
+			return 1;
+		i1 = i0 + 1;
+	}
+
+	x -= floor(x);
+	y -= j;
+	n0 = j * header->lo_max;
+	n1 = n0 + header->lo_max;
+
+	*u = (1 - y) * ((1 - x) * field_u[n0 + i0] + x * field_u[n0 + i1]) +
+	    y * ((1 - x) * field_u[n1 + i0] + x * field_u[n1 + i1]);
+	*v = (1 - y) * ((1 - x) * field_v[n0 + i0] + x * field_v[n0 + i1]) +
+	    y * ((1 - x) * field_v[n1 + i0] + x * field_v[n1 + i1]);
+
+	/* Fehlwerte (NaN) an einem der Gitterpunkte */
+	if (isnan(*u) || isnan(*v))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Lesen einer Ganzzahl ab *pos bis hoechstens end (Zeilenende). Fuehrende
+ * Leerzeichen, Tabulatoren und Wagenruecklaeufe (CRLF) werden uebersprun-
+ * gen, *pos steht danach hinter der letzten Ziffer.
+ *
+ * Rueckgabewert ist
+ *    1, wenn eine Zahl gelesen wurde (in *value)
+ *    0, wenn bis end keine Zahl mehr folgt oder ein anderes Zeichen
+ */
+int
+scan_int(const char** pos, const char* end, int* value)
+{
+	const char* c = *pos;
+	int         n = 0, sign = 1;
+
+	while ((c < end) && ((*c == ' ') || (*c == '\t') || (*c == '\r')))
+		c++;
+
+	if ((c < end) && ((*c == '-') || (*c == '+'))) {
+		sign = (*c == '-') ? -1 : 1;
+		c++;
+	}
+
+	if ((c == end) || (*c < '0') || (*c > '9'))
+		return 0;
+
+	while ((c < end) && (*c >= '0') && (*c <= '9')) {
+		n = 10 * n + (*c - '0');
+		c++;
+	}
+
+	*value = sign * n;
+	*pos = c;
+	return 1;
 }
 
-/* Erstellen einer Liste von benoetigten Winddatensaetzen und Einlesen 
- * der Windfelddaten
+/*
+ * Auswahl des IDW-Kerns: AVX2, wenn der Prozessor es unterstuetzt, sonst
+ * SSE2 (x86-64) bzw. die skalare Variante. Der Kern fuer den Gleichschritt
+ * ist ohne AVX2 skalar.
  */
 void
-read_wind_data(struct state* state, struct winddata* winddata)
+select_idw_kernel(void)
 {
-	int          i, j, k;
-	char         name[MAXLINE]; 
-	struct date* time;
-	int          res = get_int(RES);
-	struct winddata* winddata_pnt;
+	const char* name = "scalar";
 
-	winddata_pnt = winddata;
-	/* 
-	 * Wenn Aufloesung der Wetterdaten (Zeitabstand) nicht festgelegt
-	 * wurde, nimm als Maximalabstand RESMAX an
-	 */
-	if (res == 0) {
-		res = RESMAX;
+	if ((get_int(WEIGHTMODE) < 0) || (get_int(WEIGHTMODE) > 2)) {
+		printf("Unknown value for WEIGHTMODE!\n");
+		exit(1);
 	}
 
-	/* 
-	 * Errechnen der Groesse der Zeitspeicherstruktur fuer alle 
-	 * Zeitstunden des Berechnungszeitraums
-	 */
-	k = abs(get_int(TRACE)) + 2 * res;
+	idw_kernel = idw_kernel_scalar;
+	idw_kernel_lanes = idw_kernel_lanes_scalar;
+
+#ifdef USE_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		idw_kernel = idw_kernel_avx2;
+		idw_kernel_lanes = idw_kernel_lanes_avx2;
+		name = "avx2";
+	}
+	else {
+		idw_kernel = idw_kernel_sse2;
+		name = "sse2";
+	}
+#endif
+
+	printf("IDW kernel: %s\n", name);
+}
 
-	/* Reservieren des benoetigten Speichers */
-	time = (struct date *)calloc(k, sizeof(struct date));
+/*
+ * Auswaehlen der hoechstens KNEAREST naechsten Stationen der Kandidaten-
+ * liste, die im Stunden-Windfeld wind_current[f] Daten haben und naeher 
+ * als die Obergrenze KMAXR an X liegen. Bei gleichem Abstand wird die 
+ * Station mit kleinerem Stationsindex gewaehlt.
+ *
+ * Rueckgabewert ist die Anzahl der ausgewaehlten Stationen, die nach 
+ * aufsteigendem Abstand (Kosinus absteigend in cosine) in chosen stehen
+ */
+int
+select_nearest(const struct state* state, const double X[], int f, 
+    int* chosen, double* cosine)
+{
+	const struct station* station_list = state->archive->station_list;
+	int    i, k, l, m;
+	double val;
 
-	j = 0;
+	for (k = m = 0; k < state->candidate_max; k++) {
+		i = state->candidate[k];
 
-	/* Erstellen einer Liste von beoetigten Tagesdatensaetzen */
-	time_copy(state->time, time[j]);
+		if (state->slot[f][i] < 0)
+			continue;
 
-	/* 
-	 * Je nach Berechnungsrichtung vor- bzw. zurueckgehen um die maximale 
-	 * zeitliche Differenz zweier Datensaetze, um ein Fehlen von 
-	 * Datensaetzen  bei der spaeteren zeitlichen Interpolation zu 
-	 * verhindern
-	 */
-	for (i = 0; i < res; i++) {
+		val = station_list[i].X[0] * X[0] + 
+		    station_list[i].X[1] * X[1] + 
+		    station_list[i].X[2] * X[2];
 
-                /* Wenn Rueckwaertstrajektorie */
-		if (get_int(TRACE) < 0) { 
-			time_step_forward(&time[j]);
-		}
+		if (val <= state->cos_max_r)
+			continue;
+		if ((m == state->nearest_max) && (val <= cosine[m - 1]))
+			continue;
 
-                /* Wenn Vorwaertstrajektorie */
-		else { 
-			time_step_backward(&time[j]);
+		/* Einsortieren (die Kandidaten sind nach Index geordnet) */
+		if (m < state->nearest_max)
+			m++;
+		for (l = m - 1; (l > 0) && (cosine[l - 1] < val); l--) {
+			chosen[l] = chosen[l - 1];
+			cosine[l] = cosine[l - 1];
 		}
+		chosen[l] = i;
+		cosine[l] = val;
 	}
 
-	/* 
-	 * Kopieren der "korrigierten" Anfangszeit in das zweite Zeitelement
-	 * fuer die weitere Namensgenerierung
-	 */
-	j++;
-	time_copy(time[j-1], time[j]);
+	return m;
+}
 
-	/* 
-	 * Stundenweises vorsetzen in Berechnungsrichtung, bis Verfolgungs-
-	 * dauer vollstaendig durchlaufen wurde. Immer wenn ein neuer Tag 
-	 * erreicht wird, wird in ein neues Zeitelement gewechselt 
-	 * -> benoetigte Tagesdaten der einzulesenden Datensaetze sind in 
-	 * der Liste (time) gespeichert
-	 */
-	for (i = 0; i < k; i++) {
+/*
+ * Vervielfachen der Auftraege fuer eine Zeitreihe (SERIES = "YYYY MM DD 
+ * HH STEP"): Jeder Auftrag wird ab seiner Startzeit alle STEP Stunden bis
+ * einschliesslich zur Endzeit (Zeitzone der Startzeit) wiederholt; Start-
+ * position, Verfolgungszeit und Parameter bleiben gleich. Die Auftraege 
+ * eines Startorts folgen zeitlich aufsteigend aufeinander.
+ *
+ * Rueckgabewert ist das neue Auftragsfeld (job wird freigegeben)
+ */
+struct job*
+series_jobs(struct job* job, int* job_max)
+{
+	int         value[5]; /* Endzeit und Schrittweite */
+	int         i, k, n, t, first, last, span, thread_max;
+	char*       spec;
+	char*       tok;
+	struct date end;
+	struct job* series;
+
+	spec = strdup(get_string(SERIES));
+
+	for (k = 0, tok = strtok(spec, " \t"); (k < 5) && (tok != NULL);
+	     k++, tok = strtok(NULL, " \t")) {
+		value[k] = atoi(tok);
+	}
 
-                /* Wenn Rueckwaertstrajektorie */
-		if (get_int(TRACE) < 0) { 
-			time_step_backward(&time[j]);
-		}
+	if ((k < 5) || (tok != NULL)) {
+		printf("Syntax error in SERIES\n");
+		exit(1);
+	}
+	free(spec);
 
-                /* Wenn Vorwaertstrajektorie */
-		else { 
-			time_step_forward(&time[j]);
-		}
+	if (value[4] <= 0) {
+		printf("Error: SERIES step must be positive!\n");
+		exit(1);
+	}
 
-		/* Wenn naechster Tag erreicht, dann in Liste speichern */
-		if (time[j].day != time[j-1].day) {
-			j++;
-			time_copy(time[j-1], time[j]);
-		}
+	end.year = value[0];
+	end.month = value[1];
+	end.day = value[2];
+	end.hour = value[3];
+	last = date_to_hours(&end);
+
+	/* Anzahl der Startzeiten aller Auftraege */
+	for (i = n = 0; i < *job_max; i++) {
+		first = date_to_hours(&job[i].time);
+		if (first <= last)
+			n += (last - first) / value[4] + 1;
 	}
 
-	/* j ist Anzahl der generierten Tagesangaben */
-	for (i = 0; i < j; i++) {
+	if (n == 0) {
+		printf("Error: SERIES ends before the start time!\n");
+		exit(1);
+	}
 
-		/* 
-		 * Namensgenerierung einzulesender Winddatendateien aus 
-		 * generierter Zeitenliste
-		 */
+	series = calloc(n, sizeof(struct job));
 
-                /* 1999 -> 99 */
-		time[i].year = time[i].year - (time[i].year / 100 * 100); 
-		
-		if (snprintf(name, MAXLINE, "%sb%02i%02i%02i.new", 
-			get_string(METEO), time[i].year, time[i].month, 
-			time[i].day) >= MAXLINE) {
-			printf("Linebuffer too small!\n");
-			exit(1);
+	for (i = n = 0; i < *job_max; i++) {
+		first = date_to_hours(&job[i].time);
+
+		for (t = first; t <= last; t += value[4], n++) {
+			series[n] = job[i];
+			hours_to_date(t, &series[n].time);
 		}
-		
-		/*Ausgabe des generierten Dateinamens */
-		printf("%s\n", name);
-		
-		/* Daten aus naechster Datei einlesen und anhaengen */
-		winddata_pnt->next = read_file(state, name);
-		
-		if (get_int(TRACE) < 0) {
-			winddata_pnt->next = winddata_pnt->next->next;
-			if (winddata_pnt->prev != NULL)
-				winddata_pnt->next->prev = winddata_pnt;
+	}
+
+	printf("SERIES: %i jobs\n", n);
+
+	/* 
+	 * Mit WINDOW > 0 muss jeder Thread alle Tage einer Trajektorie (und
+	 * die Randtage der Interpolation) im Speicher halten koennen, sonst
+	 * werden Tage laufend verworfen und erneut eingelesen
+	 */
+	if (get_int(WINDOW) > 0) {
+		for (i = span = 0; i < n; i++) {
+			if (abs(series[i].trace) > span)
+				span = abs(series[i].trace);
 		}
-		else {
-			winddata_pnt->next->prev = winddata_pnt->prev;
-			if (winddata_pnt->prev != NULL)
-				winddata_pnt->prev->next = winddata_pnt->next;
+
+		thread_max = 1;
+#ifdef USE_PTHREAD
+		thread_max = get_int(THREADS);
+		if (thread_max <= 0) {
+			thread_max = (int)sysconf(_SC_NPROCESSORS_ONLN);
 		}
+		if (thread_max > n) {
+			thread_max = n;
+		}
+#endif
+		k = ((span + 23) / 24 + 2) * thread_max;
 
-		while (winddata_pnt->next != NULL) {
-			winddata_pnt = winddata_pnt->next;
+		if (get_int(WINDOW) < k) {
+			printf("Error: SERIES needs WINDOW=0 or WINDOW >= %i!\n",
+			    k);
+			exit(1);
 		}
 	}
-	
-	/* Speicher freigeben */
-	free(time);
+
+	free(job);
+
+	*job_max = n;
+	return series;
 }
 
 /*
- * Freigeben der reservierten Speicherbereiche und schliessen der Sammeldatei
+ * Uebernehmen der Stunden-Windfelder eines eingelesenen Puffers in den Tag
+ * d der Zeitfolge (Tagesindex in archive->timeline). Die Windfelder werden
+ * nicht kopiert, der Puffer ist danach leer.
  */
 void
-reset_state(struct state* state)
+splice_day(struct archive* archive, int d, struct prefetch* slot)
 {
-	free(state->lo);
-	free(state->la);
-	free(state->wind_data);
-	free(state->wind_current);
-	free(state->station_list);
+	int i;
+
+	for (i = 0; i < 24; i++) {
+		archive->timeline.field[d * 24 + i] = slot->field[i];
+		archive->timeline.mapped[d * 24 + i] = slot->mapped[i];
+		slot->field[i].report = NULL;
+		slot->field[i].n = 0;
+		slot->mapped[i] = 0;
+	}
 }
 
 /*
@@ -2050,122 +8399,379 @@ std_deviation(double amount, double* u_stddev,
 	}
 }
 
-/* Zuruecksetzen der uebergebenen Zeitstruktur um eine Zeitstunde */
+/*
+ * Speichern eines dicht eingelesenen Daten-Windfelds (Windrichtung, 
+ * Windgeschwindigkeit und Present-Flag p fuer jede der station_max 
+ * Stationen) als Liste der Stationen mit Daten in field. Die Eingabefelder
+ * werden dabei zurueckgesetzt.
+ */
 void
-time_step_backward(struct date* time) {
+store_field(struct field* field, int station_max, int* direction, 
+    int* speed, char* p)
+{
+	int i, n;
 
-	if (time->hour != 0) {
-		time->hour = time->hour - 1;
+	for (i = n = 0; i < station_max; i++) {
+		n += p[i];
 	}
-	else {
 
-		if (time->day != 1) {
-			time->hour = 23;
-			time->day = time->day - 1;
+	/* Auch ein Windfeld ohne Stationen mit Daten ist ein Windfeld */
+	field->n = n;
+	field->report = malloc((n + 1) * sizeof(struct report));
+
+	for (i = n = 0; i < station_max; i++) {
+		if (p[i] != 0) {
+			field->report[n].s = i;
+			field->report[n].direction = direction[i];
+			field->report[n].speed = speed[i];
+			n++;
 		}
-		else {
-			time->month = time->month - 1;
-			time->hour = 23;
+		direction[i] = speed[i] = 0;
+		p[i] = 0;
+	}
+}
+
+/*
+ * Zurueckschreiben der Position state->position in (lo, la) des 
+ * aktuellen Aufpunkts am Ende von iterate() (siehe load_position()). 
+ * Bei VECTOR sind das die einzigen Winkelfunktionen je Aufpunkt; lo und
+ * la liegen danach schon im geographischen Groessenbereich.
+ */
+void
+store_position(struct state* state)
+{
+	double* X = state->position;
+
+	if (get_int(VECTOR) == 0) {
+		state->lo[state->point] = X[0];
+		state->la[state->point] = X[1];
+		return;
+	}
+
+	normalize_vector(X);
+	state->lo[state->point] = atan2(X[1], X[0]);
+	state->la[state->point] = asin((X[2] > 1) ? 1 : 
+	    ((X[2] < -1) ? -1 : X[2]));
+}
+
+/*
+ * Vervielfachen der job_max Auftraege fuer eine Parameterstudie (SWEEP). 
+ * SWEEP enthaelt durch Leerzeichen getrennte Wertelisten der Form
+ *  NAME=Wert,Wert,...
+ * fuer die Parameter SPEED, ROT, MAXR und MINR. Jeder Auftrag wird fuer 
+ * jede Kombination der Werte (kartesisches Produkt) einmal berechnet; 
+ * nicht aufgefuehrte Parameter behalten ihren Wert. Das Feld job wird 
+ * freigegeben.
+ *
+ * Rueckgabewert ist das neue Feld der Auftraege, job_max deren Anzahl
+ */
+struct job*
+sweep_jobs(struct job* job, int* job_max)
+{
+	static const int id[4] = { SPEED, ROT, MAXR, MINR };
+	double*     value[4];   /* Werteliste je Parameter */
+	int         count[4];   /* Anzahl der Werte je Parameter */
+	double      x[4];       /* Werte der aktuellen Kombination */
+	int         i, k, c, d, n, combination_max;
+	char*       spec;
+	char*       tok;
+	char*       val;
+	char*       next_tok;
+	char*       next_val;
+	struct job* sweep;
+
+	/* Ohne Angabe nur der gesetzte Wert */
+	for (k = 0; k < 4; k++) {
+		value[k] = malloc(sizeof(double));
+		value[k][0] = (param[id[k]].type == TYP_INT) ?
+		    param[id[k]].u.i : param[id[k]].u.f;
+		count[k] = 1;
+	}
+
+	spec = strdup(get_string(SWEEP));
+
+	for (tok = strtok_r(spec, " \t", &next_tok); tok != NULL;
+	     tok = strtok_r(NULL, " \t", &next_tok)) {
+
+		if ((val = strchr(tok, '=')) == NULL) {
+			printf("Syntax error in SWEEP\n");
+			exit(1);
+		}
+		*val++ = '\0';
+
+		for (k = 0; (k < 4) && (strcmp(tok, param[id[k]].name) != 0);
+		     k++)
+			;
+		if (k == 4) {
+			printf("Parameter %s can't be swept!\n", tok);
+			exit(1);
+		}
+
+		/* Werteliste (durch Kommas getrennt) */
+		count[k] = 0;
+		for (val = strtok_r(val, ",", &next_val); val != NULL;
+		     val = strtok_r(NULL, ",", &next_val)) {
+			value[k] = realloc(value[k], 
+			    (count[k] + 1) * sizeof(double));
+			value[k][count[k]] = (param[id[k]].type == TYP_INT) ?
+			    atoi(val) : atof(val);
+			count[k] += 1;
+		}
+
+		if (count[k] == 0) {
+			printf("Syntax error in SWEEP\n");
+			exit(1);
+		}
+	}
+	free(spec);
+
+	combination_max = 1;
+	for (k = 0; k < 4; k++) {
+		combination_max *= count[k];
+	}
 
-			if (time->month == 0) {
+	sweep = calloc(*job_max * combination_max, sizeof(struct job));
 
-				time->month = 12;
-				time->year = time->year - 1;
+	/* 
+	 * Je Auftrag alle Kombinationen; c wird als Zahl mit den Stellen-
+	 * werten count[] zerlegt, MINR aendert sich am schnellsten
+	 */
+	for (i = n = 0; i < *job_max; i++) {
+		for (c = 0; c < combination_max; c++, n++) {
+			for (k = 3, d = c; k >= 0; k--) {
+				x[k] = value[k][d % count[k]];
+				d /= count[k];
 			}
 
-			if ((time->month == 1) ||
-			    (time->month == 3) ||
-			    (time->month == 5) ||
-			    (time->month == 7) ||
-			    (time->month == 8) ||
-			    (time->month == 10) ||
-			    (time->month == 12)) {
-				time->day = 31;
+			sweep[n] = job[i];
+			sweep[n].speed = x[0];
+			sweep[n].rot = x[1];
+			sweep[n].maxr = (int)x[2];
+			sweep[n].minr = (int)x[3];
+		}
+	}
+
+	printf("SWEEP: %i combinations, %i jobs\n", combination_max, n);
+
+	for (k = 0; k < 4; k++) {
+		free(value[k]);
+	}
+	free(job);
+
+	*job_max = n;
+	return sweep;
+}
+
+/*
+ * Vergeben des naechsten Auftrags an Thread id. Zuerst wird der Anfang der
+ * eigenen Warteschlange genommen, ist diese leer, wird vom Ende der 
+ * Warteschlange eines anderen Threads gestohlen.
+ *
+ * Rueckgabewert ist
+ *    der Index des Auftrags
+ *    -1, wenn keine Auftraege mehr vorhanden sind
+ */
+int
+take_job(struct pool* pool, int id)
+{
+	int i, k, job = -1;
+#ifdef USE_PTHREAD
+	struct queue* queue;
+
+	for (k = 0; (k < pool->thread_max) && (job < 0); k++) {
+
+		/* Eigene Warteschlange zuerst, dann die folgenden Threads */
+		i = (id + k) % pool->thread_max;
+		queue = &pool->queue[i];
+
+		pthread_mutex_lock(&queue->lock);
+		if (queue->first < queue->last) {
+			if (k == 0) {
+				job = queue->first;
+				queue->first += 1;
 			}
 			else {
-				if ((time->month == 4) ||
-				    (time->month == 6) ||
-				    (time->month == 9) ||
-				    (time->month == 11)) {
-					time->day = 30;
-				}
-				else {
-
-					if (((time->year % 4) == 0) &&
-					    (((time->year % 100) != 0) || 
-				             ((time->year % 400) == 0))) {
-						time->day = 29;
-					}
-					else {
-						time->day = 28;
-					}
-				}
+				queue->last -= 1;
+				job = queue->last;
 			}
 		}
+		pthread_mutex_unlock(&queue->lock);
 	}
+#else
+	(void)pool; (void)id; (void)i; (void)k;
+#endif
+	return job;
 }
 
-/* Vorsetzten der uebergebenen Zeitstruktur um eine Zeitstunde */
-void
-time_step_forward(struct date* time) {
+/*
+ * Spatprodukt (a x b) . c dreier Vektoren. Fuer Punkte auf der 
+ * Einheitskugel ist es positiv, wenn c links des Grosskreises von a nach 
+ * b liegt (von aussen gesehen).
+ */
+double
+triple_product(const double a[], const double b[], const double c[])
+{
+	return (a[1] * b[2] - a[2] * b[1]) * c[0] +
+	    (a[2] * b[0] - a[0] * b[2]) * c[1] +
+	    (a[0] * b[1] - a[1] * b[0]) * c[2];
+}
+
+/*
+ * Aktualisieren der Kandidatenliste fuer die Position X. Die Liste wird nur
+ * neu aufgebaut, wenn sich X um mehr als MARGIN von der Position entfernt 
+ * hat, um die sie zuletzt aufgebaut wurde. Da sie alle Stationen im Radius 
+ * MAXR + MARGIN um diese Position enthaelt, enthaelt sie dann weiterhin 
+ * alle Stationen im Radius MAXR um X.
+ *
+ * Rueckgabewert ist die Anzahl der Stationen in state->candidate
+ */
+int
+update_candidates(struct state* state, double X[])
+{
+	state->lookup_count += 1;
 
-	int MaxDay;
+	if ((state->candidate_max < 0) ||
+	    (state->candidate_X[0] * X[0] + state->candidate_X[1] * X[1] +
+	     state->candidate_X[2] * X[2] < state->cos_margin)) {
 
-	if (time->hour != 23) {
-		time->hour = time->hour + 1;
+		state->candidate_max = find_stations(&state->archive->index, 
+		    X, (state->job.maxr + MARGIN) / RE, state->candidate);
+
+		state->candidate_X[0] = X[0];
+		state->candidate_X[1] = X[1];
+		state->candidate_X[2] = X[2];
+
+		state->rebuild_count += 1;
+		state->candidate_count += 1;
 	}
-	else {
-		if ((time->month == 1) ||
-		    (time->month == 3) ||
-		    (time->month == 5) ||
-		    (time->month == 7) ||
-		    (time->month == 8) ||
-		    (time->month == 10) ||
-		    (time->month == 12)) {
-			MaxDay = 31;
-		}
-		else {
-			if ((time->month == 4) ||
-			    (time->month == 6) ||
-			    (time->month == 9) ||
-			    (time->month == 11)) {
-				MaxDay = 30;
-			}
-			else {
 
-				if (((time->year % 4) == 0) &&
-				    (((time->year % 100) != 0) || 
-				     ((time->year % 400) == 0))) {
-					MaxDay = 29;
-				}
-				else {
-					MaxDay = 28;
-				}
+	return state->candidate_max;
+}
+
+/*
+ * Aktualisieren der Kandidatenliste fuer die Auswahl der KNEAREST 
+ * naechsten Stationen (KNEAREST > 0). Die Liste wird neu aufgebaut, wenn
+ * sich X um mehr als MARGIN von der Position entfernt hat, um die sie 
+ * zuletzt aufgebaut wurde, oder wenn sich die Stunden-Windfelder 
+ * geaendert haben. Dazu wird der Suchradius ausgehend von einer 
+ * Indexzelle verdoppelt, bis er in jedem Stunden-Windfeld die KNEAREST
+ * naechsten Stationen (bzw. alle Stationen mit Daten) sicher enthaelt oder
+ * KMAXR erreicht. Liegt die letzte dieser Stationen im Abstand d, enthaelt 
+ * die Liste alle Stationen im Radius d + 2 * MARGIN und damit fuer jede
+ * Position im Umkreis MARGIN deren KNEAREST naechste Stationen.
+ *
+ * Rueckgabewert ist die Anzahl der Stationen in state->candidate
+ */
+int
+update_nearest(struct state* state, double X[])
+{
+	const struct station_index* index = &state->archive->index;
+	int    f, m;
+	double cap, radius, reach, margin;
+
+	state->lookup_count += 1;
+
+	if ((state->candidate_max >= 0) && 
+	    (state->nearest_hour == state->hour_count) &&
+	    (state->candidate_X[0] * X[0] + state->candidate_X[1] * X[1] +
+	     state->candidate_X[2] * X[2] >= state->cos_margin)) {
+		return state->candidate_max;
+	}
+
+	cap = (get_int(KMAXR) > 0) ? get_int(KMAXR) / RE : M_PI;
+	margin = MARGIN / RE;
+
+	/* Ringsuche mit verdoppeltem Radius */
+	for (radius = index->la_cell; ; radius *= 2) {
+		if (radius > cap)
+			radius = cap;
+
+		state->candidate_max = find_stations(index, X, radius, 
+		    state->candidate);
+
+		/* Entfernung der letzten benoetigten Station */
+		reach = 0;
+		for (f = 0; f < 2; f++) {
+			m = select_nearest(state, X, f, state->nearest, 
+			    state->nearest_cos);
+
+			if ((m < state->nearest_max) && 
+			    (m < state->wind_current[f].n)) {
+				reach = cap;
+				break;
 			}
+			if ((m > 0) && (acos(state->nearest_cos[m - 1]) > reach))
+				reach = acos(state->nearest_cos[m - 1]);
 		}
 
-		if (time->day < MaxDay) {
-			time->day = time->day + 1;
-			time->hour = 0;
-		}
-		else {
-			time->month = time->month + 1;
-			time->day = 1;
-			time->hour = 0;
+		if ((reach <= radius) || (radius >= cap))
+			break;
+	}
+
+	if (reach + 2 * margin < cap + margin)
+		radius = reach + 2 * margin;
+	else
+		radius = cap + margin;
+
+	state->candidate_max = find_stations(index, X, radius, 
+	    state->candidate);
+
+	state->candidate_X[0] = X[0];
+	state->candidate_X[1] = X[1];
+	state->candidate_X[2] = X[2];
+
+	state->nearest_hour = state->hour_count;
+	state->rebuild_count += 1;
+	state->candidate_count += 1;
+
+	return state->candidate_max;
+}
+
+/*
+ * Suchen des Dreiecks einer Delaunay-Triangulation, das die Position X 
+ * enthaelt, durch Wandern ab dem Dreieck t: Liegt X jenseits einer Kante,
+ * wird zum Nachbardreieck ueber diese Kante gewechselt. Die Reihenfolge 
+ * der geprueften Kanten wechselt mit jedem Schritt, damit die Wanderung 
+ * auch bei Rundungsfehlern nicht im Kreis laeuft. Liegt X nahe am 
+ * Startdreieck, sind nur wenige Schritte noetig.
+ *
+ * Rueckgabewert ist der Index des Dreiecks
+ */
+int
+walk_mesh(const struct mesh* mesh, const double X[], int t)
+{
+	const struct triangle* triangle;
+	int                    i, j, step;
+
+	for (step = 0; step < 4 * mesh->triangle_max; step++) {
+		triangle = &mesh->triangle[t];
+
+		for (j = 0; j < 3; j++) {
+			i = (step + j) % 3;
 
-			if (time->month > 12) {
-				time->month = 1;
-				time->year = time->year + 1;
+			if (triple_product(
+			    &mesh->X[3 * triangle->v[(i + 1) % 3]], 
+			    &mesh->X[3 * triangle->v[(i + 2) % 3]], X) < 0) {
+				t = triangle->n[i];
+				break;
 			}
 		}
+
+		if (j == 3)
+			break;
 	}
+
+	return t;
 }
 
 /*
  * Zeitliches Interpolieren eines neuen Stundenwindfeldes fuer wind_current 
  * aus den beiden eingelesenen Daten-Windfeldern in wind_data. Wenn zur 
  * betrachteten Zeitstunde keine Daten vorliegen, wird aus den Daten
- * vor und nach der betrachteten Zeitstunde zeitlich gewichtet interpoliert.
+ * vor und nach der betrachteten Zeitstunde zeitlich gewichtet interpoliert
+ * (nur fuer Stationen, die in beiden Daten-Windfeldern enthalten sind).
+ * Die Windmeldungen werden dabei mit den Parametern des Auftrags 
+ * korrigiert (siehe correct_wind()).
  *
  * wind_data[0]|------------------------------|wind_data[1]
  *             0          |                 data_diff=3
@@ -2174,120 +8780,132 @@ time_step_forward(struct date* time) {
 void
 wind_of_next_hour(struct state* state)
 {
-	int j;
-	/* 
-	 * Wenn zwischen eingelesenen Datenbloecken keine Zeitdifferenz 
-	 * besteht 
+	struct wind_field*  current = &state->wind_current[0];
+	const struct field* data1 = state->wind_data[0];
+	const struct field* data2 = state->wind_data[1];
+	int*                slot = state->slot[0];
+	int                 i, j, n;
+	struct wind         wind1, wind2;
+
+	/*
+	 * Wenn zwischen eingelesenen Datenbloecken keine Zeitdifferenz
+	 * besteht
 	 */
 	if (state->data_diff == 0) {
 		printf("Error: no time difference between wind data!\n");
 		exit (1);
 	}
-	
-	for (j = 0; j < state->station_max; j++) {
-		
-		/* 
-		 * Wenn Berechnungszeit (diff) mit Datenblockzeit von 
-		 * wind_data zusammenfaellt
-		 */
-		if (state->diff == 0) {
 
-                        /* Wenn Winddaten vorhanden sind */
-			if (state->wind_data[j].p != 0) {
-				
-				state->wind_current[j].u = 
-				    state->wind_data[j].u;
-				
-				state->wind_current[j].v = 
-				    state->wind_data[j].v;
-				
-				state->wind_current[j].p = 1;
-				
-			}
+	/* Gepackte Winddaten des IDW-Kerns sind ab jetzt veraltet */
+	state->hour_count += 1;
 
-			/* Wenn keine Winddaten vorhanden sind */
-			else { 
-				
-				state->wind_current[j].u = 0;
-				state->wind_current[j].v = 0;
-				state->wind_current[j].p = 0;
-			}
+	/* Stationen des bisherigen Stunden-Windfeldes austragen */
+	for (i = 0; i < current->n; i++) {
+		slot[current->wind[i].s] = -1;
+	}
+
+	n = 0;
+
+	/*
+	 * Wenn Berechnungszeit (diff) mit Datenblockzeit von
+	 * wind_data zusammenfaellt
+	 */
+	if (state->diff == 0) {
+		for (i = 0; i < data1->n; i++) {
+			correct_wind(state, &data1->report[i],
+			    &current->wind[n]);
+			slot[current->wind[n].s] = n;
+			n++;
 		}
-		
-		/* 
-		 * Wenn Berechnungszeit (diff) zwischen den Zeiten der Daten-
-		 * bloecke von wind_data lieg  -> interpolieren
-		 */
-		else { 
-			/* 
-			 * Wenn Daten in beiden Daten-Windfeldern vorhanden 
-			 * sind 
-			 */
-			
-			if ((state->wind_data[j].p != 0) && 
-			    (state->wind_data[state->station_max + j].p 
-				!= 0)) {
-				state->wind_current[j].u = 
-				    state->wind_data[j].u *
-				    (double)(state->data_diff - 
-					state->diff) /
-				    (double)state->data_diff + 
-				    state->wind_data[state->
-					station_max + j].u *
-				    (double)state->diff / 
-				    (double)state->data_diff;
-				
-				state->wind_current[j].v = 
-				    state->wind_data[j].v *
-				    (double)(state->data_diff - 
-					state->diff) /
-				    (double)state->data_diff + 
-				    state->wind_data[state->
-					station_max + j].v *
-				    (double)state->diff / 
-				    (double)state->data_diff;
-				state->wind_current[j].p = 1;
+	}
+
+	/*
+	 * Wenn Berechnungszeit (diff) zwischen den Zeiten der Daten-
+	 * bloecke von wind_data lieg  -> interpolieren. Beide Listen sind
+	 * nach Stationsindex geordnet und werden gemeinsam durchlaufen.
+	 */
+	else {
+		for (i = j = 0; (i < data1->n) && (j < data2->n); ) {
+
+			if (data1->report[i].s < data2->report[j].s) {
+				i++;
+				continue;
 			}
-				
-			/* 
-			 * Wenn nicht in beiden Daten-Windfeldern Daten 
-			 * vorhanden sind 
-			 */
-			else { 
-				
-				state->wind_current[j].u = 0;
-				state->wind_current[j].v = 0;
-				state->wind_current[j].p = 0;
+			if (data1->report[i].s > data2->report[j].s) {
+				j++;
+				continue;
 			}
+
+			/*
+			 * Wenn Daten in beiden Daten-Windfeldern vorhanden
+			 * sind
+			 */
+			correct_wind(state, &data1->report[i], &wind1);
+			correct_wind(state, &data2->report[j], &wind2);
+
+			current->wind[n].s = wind1.s;
+
+			current->wind[n].u =
+			    wind1.u *
+			    (double)(state->data_diff - state->diff) /
+			    (double)state->data_diff +
+			    wind2.u *
+			    (double)state->diff /
+			    (double)state->data_diff;
+
+			current->wind[n].v =
+			    wind1.v *
+			    (double)(state->data_diff - state->diff) /
+			    (double)state->data_diff +
+			    wind2.v *
+			    (double)state->diff /
+			    (double)state->data_diff;
+
+			slot[current->wind[n].s] = n;
+			n++;
+			i++;
+			j++;
 		}
 	}
-}
 
-/* Werte mit zu grosser Abweichung rauswerfen */
-void
-z_transformation_check(struct wind* wind_in_range, double u_average,
-    double v_average, double u_stddev, double v_stddev,
-    double stddev, int i)
-{
-	/* Wenn Daten vorhanden sind */
-	if (wind_in_range[i].p != 0) {
+	current->n = n;
 
-		/* 
-                 * Z-Transformation
-		 *
-		 * >> z = abs(xi - Mittelwert) / Standardabweichung <<
-		 *
-		 */
+	/* 
+	 * Delaunay-Triangulation bzw. Gitter-Windfeld zum neuen Stunden-
+	 * Windfeld
+	 */
+	if (get_int(DELAUNAY) != 0) {
+		release_mesh(state->archive, state->mesh[0]);
+		state->mesh[0] = acquire_mesh(state);
+	}
+	else if (get_float(GRID) > 0.0) {
+		release_grid(state->archive, state->grid[0]);
+		state->grid[0] = acquire_grid(state);
+	}
+}
 
-		/* Wennn Abweichung groesser als gefordert */
-		if (((fabs(wind_in_range[i].u - u_average)
-			 / u_stddev) > stddev) ||
-		    ((fabs(wind_in_range[i].v - v_average)
-			/ v_stddev) > stddev)) {
+/* Hauptfunktion eines Threads: Bearbeiten von Auftraegen bis keine mehr da */
+void*
+worker_main(void* arg)
+{
+	struct worker* worker = arg;
+	struct pool*   pool = worker->pool;
+	int            i;
+
+	while ((i = take_job(worker->pool, worker->id)) >= 0) {
+		if (i + 1 < pool->unit_max) {
+			prefetch_job(pool->archive, &pool->job[(pool->group != 
+			    NULL) ? pool->group[i + 1] : i + 1]);
+		}
 
-                        /* Daten i aus der Berechnung nehmen */
-			wind_in_range[i].p = 0; 
+		if (pool->group != NULL) {
+			run_lockstep(pool->archive, &pool->job[pool->group[i]],
+			    pool->group[i + 1] - pool->group[i]);
+		}
+		else {
+			run_job(pool->archive, &pool->job[i]);
 		}
 	}
-}
 
+	return NULL;
+}
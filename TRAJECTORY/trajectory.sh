@@ -21,5 +21,24 @@ export OUTPUT=traj/;         # Ausgabeverzeichnis
 export STDDEVIATION=0.0;     # zulaessige Standardabweichung der Windvektoren
 export DATAUNIT=0;           # 0: kn | 1: m/s | 2: aus Stationsliste
 export RES=3;                # zeitliche Winddatenaufloesung (0: max. 24h)
+export JOBS=;                # Auftragsdatei fuer Batchbetrieb (leer: aus)
+export THREADS=1;            # Anzahl der Threads (0: Prozessoranzahl)
+export WEIGHTMODE=0;         # Abstandswichtung (0: Bogen, 1: Sehne, 2: Polynom)
+export ARCHIVE=;             # gepacktes Winddatenarchiv (leer: METEO lesen)
+export PACK=;                # METEO in dieses Archiv packen (leer: aus)
+export WINDOW=0;             # Tage im Speicher (0: alle vorab einlesen)
+export PREFETCH=1;           # naechsten Tag vorausladen (mit WINDOW/SERIES)
+export SWEEP=;               # Parameterstudie, z.B. "SPEED=1.5,2 ROT=0,10"
+export GRID=0.0;             # Gitterweite der Gitter-Windfelder (0.0: aus)
+export GRIDCACHE=;           # Verzeichnis der Gitter-Windfelder
+export WINDGRID=;            # Windgitterdatei (leer: Stationsmeldungen)
+export KNEAREST=0;           # Anzahl naechster Stationen (0: alle in MAXR)
+export KMAXR=0;              # Obergrenze des Abstands bei KNEAREST (km)
+export DELAUNAY=0;           # Interpolation in Delaunay-Dreiecken (0: aus)
+export INTEGRATOR=0;         # Integrationsverfahren (0: Euler, 1: Heun, 2: RK4)
+export TOL=0.0;              # Fehlertoleranz je Schritt in km (0.0: fest IPERH)
+export VECTOR=0;             # Integration mit Einheitsvektoren (0: aus)
+export LOCKSTEP=0;           # Trajektorien je Gruppe im Gleichschritt (0: aus)
+export SERIES=;              # Zeitreihe bis Endzeit, z.B. "2007 12 31 21 3"
 
 ./trajectory;